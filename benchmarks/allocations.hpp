@@ -0,0 +1,66 @@
+// benchmarks/allocations.hpp                                         -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_BENCHMARKS_ALLOCATIONS
+#define INCLUDED_BENCHMARKS_ALLOCATIONS
+
+#include "benchmark.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Replaces the global allocation functions to count allocations. This header
+// defines non-inline functions and needs to be included in exactly one
+// translation unit of a benchmark program.
+
+namespace benchmark {
+namespace {
+auto counted_allocate(std::size_t size) -> void* {
+    allocations.fetch_add(1u, std::memory_order_relaxed);
+    if (void* ptr{std::malloc(size == 0u ? 1u : size)})
+        return ptr;
+    throw std::bad_alloc();
+}
+auto counted_allocate(std::size_t size, std::align_val_t align) -> void* {
+    allocations.fetch_add(1u, std::memory_order_relaxed);
+    std::size_t alignment{std::size_t(align)};
+#if defined(_MSC_VER)
+    if (void* ptr{::_aligned_malloc(size == 0u ? 1u : size, alignment)})
+#else
+    if (void* ptr{std::aligned_alloc(alignment, (size + alignment) / alignment * alignment)})
+#endif
+        return ptr;
+    throw std::bad_alloc();
+}
+auto counted_deallocate(void* ptr, std::align_val_t) noexcept -> void {
+#if defined(_MSC_VER)
+    ::_aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+const bool enable_counting{(counting_allocations = true)};
+} // namespace
+} // namespace benchmark
+
+void* operator new(std::size_t size) { return benchmark::counted_allocate(size); }
+void* operator new[](std::size_t size) { return benchmark::counted_allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return benchmark::counted_allocate(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return benchmark::counted_allocate(size, align); }
+void  operator delete(void* ptr) noexcept { std::free(ptr); }
+void  operator delete[](void* ptr) noexcept { std::free(ptr); }
+void  operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void  operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void  operator delete(void* ptr, std::align_val_t a) noexcept { benchmark::counted_deallocate(ptr, a); }
+void  operator delete[](void* ptr, std::align_val_t a) noexcept { benchmark::counted_deallocate(ptr, a); }
+void  operator delete(void* ptr, std::size_t, std::align_val_t a) noexcept { benchmark::counted_deallocate(ptr, a); }
+void  operator delete[](void* ptr, std::size_t, std::align_val_t a) noexcept { benchmark::counted_deallocate(ptr, a); }
+
+// ----------------------------------------------------------------------------
+
+#endif
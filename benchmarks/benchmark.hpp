@@ -0,0 +1,76 @@
+// benchmarks/benchmark.hpp                                           -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_BENCHMARKS_BENCHMARK
+#define INCLUDED_BENCHMARKS_BENCHMARK
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+// ----------------------------------------------------------------------------
+
+namespace benchmark {
+/*!
+ * \brief Prevent the compiler from optimizing away the computation of a value
+ */
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink{};
+    sink = &value;
+#endif
+}
+
+/*!
+ * \brief Number of allocations made via the global `operator new`
+ *
+ * The count is only maintained by programs including "allocations.hpp".
+ */
+inline std::atomic<std::size_t> allocations{};
+inline bool                     counting_allocations{};
+
+/*!
+ * \brief Get the number of iterations from the command line (or use a default)
+ */
+inline auto iterations(int ac, char* av[], std::size_t dflt) -> std::size_t {
+    return 1 < ac ? std::size_t(std::strtoull(av[1], nullptr, 10)) : dflt;
+}
+
+/*!
+ * \brief Run `fun()` `count` times and report the average time per operation
+ *
+ * If each call of `fun()` executes `batch` operations the reported time is
+ * divided accordingly. If allocations are counted the number of allocations
+ * per operation is reported, too.
+ */
+template <typename Fun>
+auto run(std::string_view name, std::size_t count, Fun&& fun, std::size_t batch = 1u) -> double {
+    fun();
+    std::size_t before{allocations.load(std::memory_order_relaxed)};
+    auto        start{std::chrono::steady_clock::now()};
+    for (std::size_t i{}; i != count; ++i) {
+        fun();
+    }
+    auto        end{std::chrono::steady_clock::now()};
+    std::size_t allocated{allocations.load(std::memory_order_relaxed) - before};
+    double      ops{double(count * batch)};
+    double      ns{std::chrono::duration<double, std::nano>(end - start).count() / (ops < 1.0 ? 1.0 : ops)};
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(12) << std::fixed
+              << std::setprecision(2) << ns << " ns/op";
+    if (counting_allocations)
+        std::cout << std::setw(10) << double(allocated) / (ops < 1.0 ? 1.0 : ops) << " allocs/op";
+    std::cout << "\n";
+    return ns;
+}
+} // namespace benchmark
+
+// ----------------------------------------------------------------------------
+
+#endif
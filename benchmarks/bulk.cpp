@@ -0,0 +1,64 @@
+// benchmarks/bulk.cpp                                                -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "benchmark.hpp"
+#include <beman/execution.hpp>
+#include <beman/task.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ex = beman::execution;
+
+// ----------------------------------------------------------------------------
+// Measures the time per index of a bulk operation on a work_stealing_context
+// with an increasing number of threads, both using the context's scheduler
+// directly and type-erased via task_scheduler. The inline_scheduler is used
+// as the sequential baseline.
+
+namespace {
+auto work(std::vector<double>& data, std::size_t i) -> void {
+    double value{double(i)};
+    for (std::size_t j{}; j != 200u; ++j)
+        value = value * 0.999 + 1.0;
+    data[i] = value;
+}
+
+template <typename Scheduler>
+auto measure(const std::string& name, Scheduler sched, std::size_t count, std::vector<double>& data) -> double {
+    return benchmark::run(
+        name,
+        count,
+        [&data, sched] {
+            ex::sync_wait(ex::bulk(ex::schedule(sched), data.size(), [&data](std::size_t i) { work(data, i); }));
+            benchmark::do_not_optimize(data.front());
+        },
+        data.size());
+}
+} // namespace
+
+int main(int ac, char* av[]) {
+    const std::size_t   count{benchmark::iterations(ac, av, 20u)};
+    const std::size_t   cores{std::max(1u, std::thread::hardware_concurrency())};
+    std::vector<double> data(1u << 16u);
+
+    const double sequential{measure("inline_scheduler", ex::inline_scheduler{}, count, data)};
+    std::vector<std::size_t> counts;
+    for (std::size_t threads{1u}; threads < cores; threads *= 2u)
+        counts.push_back(threads);
+    counts.push_back(cores);
+
+    for (std::size_t threads : counts) {
+        beman::task::work_stealing_context context(threads);
+        const std::string                  suffix{" x" + std::to_string(threads)};
+
+        measure("work_stealing" + suffix, context.get_scheduler(), count, data);
+        const double erased{measure(
+            "task_scheduler(work_stealing)" + suffix, ex::task_scheduler(context.get_scheduler()), count, data)};
+        std::cout << "    speedup over inline_scheduler: " << std::setprecision(2) << sequential / erased << "\n";
+    }
+}
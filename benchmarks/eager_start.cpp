@@ -0,0 +1,65 @@
+// benchmarks/eager_start.cpp                                         -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "benchmark.hpp"
+#include <beman/execution.hpp>
+#include <beman/task.hpp>
+#include <cstddef>
+#include <iostream>
+#include <tuple>
+
+namespace ex = beman::execution;
+
+// ----------------------------------------------------------------------------
+// Compares lazily started tasks with tasks using an environment requesting
+// an eager start when used for a lookup which usually completes
+// synchronously (a cache hit):
+// - co_await of a task returning a cached value (reported per co_await)
+// - co_await of a task which needs to schedule (a cache miss)
+// For a hit the eagerly started task completes from await_ready() and the
+// awaiting task doesn't suspend. For a miss both variants suspend.
+
+namespace {
+struct lazy_env {};
+struct eager_env {
+    static constexpr bool eager_start{true};
+};
+
+template <typename Env>
+auto lookup(std::size_t key, bool hit) -> ex::task<std::size_t, Env> {
+    if (not hit)
+        co_await ex::schedule(co_await ex::read_env(ex::get_scheduler));
+    co_return key;
+}
+
+template <typename Env>
+auto lookups(std::size_t count, bool hit) -> ex::task<std::size_t> {
+    std::size_t sum{};
+    for (std::size_t i{}; i != count; ++i)
+        sum += co_await lookup<Env>(i, hit);
+    co_return sum;
+}
+
+template <typename Env>
+auto measure(const char* name, std::size_t count, std::size_t awaits, bool hit) -> double {
+    return benchmark::run(
+        name,
+        count,
+        [awaits, hit] {
+            auto [value]{ex::sync_wait(lookups<Env>(awaits, hit)).value_or(std::tuple(0u))};
+            benchmark::do_not_optimize(value);
+        },
+        awaits);
+}
+} // namespace
+
+int main(int ac, char* av[]) {
+    const std::size_t count{benchmark::iterations(ac, av, 10000u)};
+    const std::size_t awaits{64u};
+
+    const double lazy_hit{measure<lazy_env>("lazy task, cache hit (per co_await)", count, awaits, true)};
+    const double eager_hit{measure<eager_env>("eager task, cache hit (per co_await)", count, awaits, true)};
+    const double lazy_miss{measure<lazy_env>("lazy task, cache miss (per co_await)", count, awaits, false)};
+    const double eager_miss{measure<eager_env>("eager task, cache miss (per co_await)", count, awaits, false)};
+    std::cout << "eager/lazy: hit " << eager_hit / lazy_hit << ", miss " << eager_miss / lazy_miss << "\n";
+}
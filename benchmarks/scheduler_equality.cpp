@@ -0,0 +1,64 @@
+// benchmarks/scheduler_equality.cpp                                  -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "benchmark.hpp"
+#include <beman/execution.hpp>
+#include <beman/task.hpp>
+#include <cstddef>
+
+namespace ex = beman::execution;
+
+// ----------------------------------------------------------------------------
+// Compares the cost of comparing type-erased schedulers: task_scheduler uses a
+// type tag while the baseline uses dynamic_cast like task_scheduler used to.
+
+namespace {
+struct cast_base {
+    cast_base()                            = default;
+    cast_base(const cast_base&)            = delete;
+    cast_base(cast_base&&)                 = delete;
+    virtual ~cast_base()                   = default;
+    cast_base& operator=(const cast_base&) = delete;
+    cast_base& operator=(cast_base&&)      = delete;
+
+    virtual bool equals(const cast_base*) const = 0;
+};
+template <typename Scheduler>
+struct cast_concrete final : cast_base {
+    Scheduler scheduler;
+    explicit cast_concrete(Scheduler s) : scheduler(s) {}
+    bool equals(const cast_base* o) const override {
+        auto other{dynamic_cast<const cast_concrete*>(o)};
+        return other ? this->scheduler == other->scheduler : false;
+    }
+};
+} // namespace
+
+int main(int ac, char* av[]) {
+    const std::size_t count{benchmark::iterations(ac, av, 10000000u)};
+    ex::run_loop      loop;
+
+    ex::task_scheduler loop_sched(loop.get_scheduler());
+    ex::task_scheduler inline_sched(ex::inline_scheduler{});
+    benchmark::run("task_scheduler == (same type)", count, [&] {
+        benchmark::do_not_optimize(loop_sched == loop_sched);
+    });
+    benchmark::run("task_scheduler == (different type)", count, [&] {
+        benchmark::do_not_optimize(loop_sched == inline_sched);
+    });
+    auto raw{loop.get_scheduler()};
+    benchmark::run("task_scheduler == scheduler", count, [&] { benchmark::do_not_optimize(loop_sched == raw); });
+
+    cast_concrete<decltype(loop.get_scheduler())> cast_loop(loop.get_scheduler());
+    cast_concrete<ex::inline_scheduler>           cast_inline(ex::inline_scheduler{});
+    const cast_base*                              loop_ptr{&cast_loop};
+    const cast_base*                              inline_ptr{&cast_inline};
+    benchmark::do_not_optimize(loop_ptr);
+    benchmark::do_not_optimize(inline_ptr);
+    benchmark::run("dynamic_cast equals (same type)", count, [&] {
+        benchmark::do_not_optimize(loop_ptr->equals(loop_ptr));
+    });
+    benchmark::run("dynamic_cast equals (different type)", count, [&] {
+        benchmark::do_not_optimize(loop_ptr->equals(inline_ptr));
+    });
+}
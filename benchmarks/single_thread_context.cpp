@@ -0,0 +1,78 @@
+// benchmarks/single_thread_context.cpp                               -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "benchmark.hpp"
+#include <beman/execution.hpp>
+#include <beman/task/detail/single_thread_context.hpp>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <latch>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+// Compares the throughput of work scheduled from several threads onto a
+// single_thread_context using a run_loop to one using an mpsc_run_loop.
+// Each producer thread connects its operations up front and then starts
+// them as fast as possible.
+
+namespace {
+template <typename Scheduler>
+struct producers {
+    struct receiver {
+        using receiver_concept = ex::receiver_tag;
+        std::latch* done;
+        void        set_value() && noexcept { this->done->count_down(); }
+        void        set_stopped() && noexcept { std::terminate(); }
+    };
+    struct item {
+        decltype(ex::connect(ex::schedule(std::declval<Scheduler&>()), std::declval<receiver>())) state;
+        item(Scheduler sched, receiver r) : state(ex::connect(ex::schedule(sched), std::move(r))) {}
+    };
+
+    static auto run(Scheduler sched, std::size_t threads, std::size_t count) -> void {
+        std::latch                    done{std::ptrdiff_t(threads * count)};
+        std::vector<std::deque<item>> items(threads);
+        for (auto& list : items)
+            for (std::size_t i{}; i != count; ++i)
+                list.emplace_back(sched, receiver{&done});
+        std::latch               go{std::ptrdiff_t(threads)};
+        std::vector<std::thread> workers;
+        for (auto& list : items)
+            workers.emplace_back([&go, &list] {
+                go.arrive_and_wait();
+                for (auto& i : list)
+                    ex::start(i.state);
+            });
+        done.wait();
+        for (auto& w : workers)
+            w.join();
+    }
+};
+
+template <typename Context>
+auto measure(const std::string& name, std::size_t count, std::size_t threads) -> void {
+    Context context;
+    using scheduler = decltype(context.get_scheduler());
+    benchmark::run(
+        name + " x" + std::to_string(threads),
+        count,
+        [&context, threads] { producers<scheduler>::run(context.get_scheduler(), threads, 10000u); },
+        threads * 10000u);
+}
+} // namespace
+
+int main(int ac, char* av[]) {
+    const std::size_t count{benchmark::iterations(ac, av, 20u)};
+
+    for (std::size_t threads : {1u, 2u, 4u, 8u}) {
+        measure<bt::single_thread_context>("run_loop", count, threads);
+        measure<bt::mpsc_single_thread_context>("mpsc_run_loop", count, threads);
+    }
+}
@@ -0,0 +1,93 @@
+// benchmarks/state_dispatch.cpp                                      -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "benchmark.hpp"
+#include <beman/execution.hpp>
+#include <beman/task.hpp>
+#include <coroutine>
+#include <cstddef>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+// Compares queries through the function pointer table/bound references used
+// by state_base to the virtual function interface state_base used to have.
+
+namespace {
+struct environment {};
+
+struct virtual_state {
+    using stop_source_type = bt::stop_source_of_t<environment>;
+    using stop_token_type  = decltype(std::declval<stop_source_type>().get_token());
+    using scheduler_type   = bt::scheduler_of_t<environment>;
+
+    virtual_state()                                = default;
+    virtual_state(const virtual_state&)            = delete;
+    virtual_state(virtual_state&&)                 = delete;
+    virtual ~virtual_state()                       = default;
+    virtual_state& operator=(const virtual_state&) = delete;
+    virtual_state& operator=(virtual_state&&)      = delete;
+
+    auto get_stop_token() -> stop_token_type { return this->do_get_stop_token(); }
+    auto get_start_scheduler() -> scheduler_type { return this->do_get_start_scheduler(); }
+
+    virtual auto do_get_stop_token() -> stop_token_type      = 0;
+    virtual auto do_get_start_scheduler() -> scheduler_type = 0;
+};
+
+struct virtual_awaiter final : virtual_state {
+    scheduler_type  scheduler{ex::inline_scheduler()};
+    stop_token_type token{};
+
+    auto do_get_stop_token() -> stop_token_type override { return this->token; }
+    auto do_get_start_scheduler() -> scheduler_type override { return this->scheduler; }
+};
+
+struct table_awaiter : bt::state_base<void, environment> {
+    scheduler_type  scheduler{ex::inline_scheduler()};
+    stop_token_type token{};
+    environment     env{};
+
+    table_awaiter() : bt::state_base<void, environment>(this) {
+        this->bind(this->scheduler, this->env);
+        this->bind_stop_token(this->token);
+    }
+    auto do_complete() -> std::coroutine_handle<> { return std::noop_coroutine(); }
+    auto do_get_allocator() -> allocator_type { return {}; }
+};
+
+template <typename State>
+auto query(State& state) -> bool {
+    return state.get_stop_token().stop_requested() || state.get_start_scheduler() != state.get_start_scheduler();
+}
+
+ex::task<std::size_t> read_queries(std::size_t count) {
+    std::size_t rc{};
+    for (std::size_t i{}; i != count; ++i) {
+        auto token{co_await ex::read_env(ex::get_stop_token)};
+        rc += token.stop_requested() ? 1u : 0u;
+    }
+    co_return rc;
+}
+} // namespace
+
+int main(int ac, char* av[]) {
+    const std::size_t count{benchmark::iterations(ac, av, 1000000u)};
+
+    virtual_awaiter v{};
+    virtual_state&  vs{v};
+    benchmark::run("virtual state queries", count, [&vs] { benchmark::do_not_optimize(query(vs)); });
+
+    table_awaiter t{};
+    benchmark::run("state_base queries", count, [&t] { benchmark::do_not_optimize(query(t)); });
+
+    benchmark::run(
+        "nested task read_env(get_stop_token)",
+        1u,
+        [count] {
+            ex::sync_wait(
+                [](std::size_t n) -> ex::task<> { benchmark::do_not_optimize(co_await read_queries(n)); }(count));
+        },
+        count);
+}
@@ -0,0 +1,114 @@
+// benchmarks/task_overhead.cpp                                       -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "allocations.hpp"
+#include "benchmark.hpp"
+#include <beman/execution.hpp>
+#include <beman/task.hpp>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+
+namespace ex = beman::execution;
+
+// ----------------------------------------------------------------------------
+// Measures the basic overhead of tasks:
+// - creating and destroying a task which is never started
+// - sync_wait() of a task which immediately returns
+// - a chain of nested co_await of tasks (reported per level)
+// - co_await of just() which completes inline (reported per co_await)
+// - co_await of just() | then() which goes through affine (reported per co_await)
+// - a schedule() round trip through task_scheduler
+// - reporting an error using co_yield with_error
+// - reporting an error by throwing an exception
+// The number of allocations per operation is reported, too.
+
+namespace {
+struct error_env {
+    using error_types = ex::completion_signatures<ex::set_error_t(int)>;
+};
+
+auto trivial() -> ex::task<int> { co_return 1; }
+
+auto nested(std::size_t depth) -> ex::task<std::size_t> {
+    co_return depth == 0u ? 0u : 1u + co_await nested(depth - 1u);
+}
+
+auto await_just(std::size_t count) -> ex::task<std::size_t> {
+    std::size_t sum{};
+    for (std::size_t i{}; i != count; ++i)
+        sum += co_await ex::just(i);
+    co_return sum;
+}
+
+auto await_then(std::size_t count) -> ex::task<std::size_t> {
+    std::size_t sum{};
+    for (std::size_t i{}; i != count; ++i)
+        sum += co_await (ex::just(i) | ex::then([](std::size_t v) { return v; }));
+    co_return sum;
+}
+
+auto yield_error() -> ex::task<int, error_env> {
+    co_yield ex::with_error{17};
+    co_return 0;
+}
+
+auto throw_error() -> ex::task<int> {
+    throw std::runtime_error("error");
+    co_return 0;
+}
+} // namespace
+
+int main(int ac, char* av[]) {
+    const std::size_t count{benchmark::iterations(ac, av, 100000u)};
+    const std::size_t depth{16u};
+    const std::size_t awaits{64u};
+
+    benchmark::run("task creation+destruction", count, [] {
+        auto t{trivial()};
+        benchmark::do_not_optimize(t);
+    });
+    benchmark::run("sync_wait(trivial task)", count, [] {
+        auto [value]{ex::sync_wait(trivial()).value_or(std::tuple(0))};
+        benchmark::do_not_optimize(value);
+    });
+    benchmark::run(
+        "nested co_await task (per level)",
+        count,
+        [depth] {
+            auto [value]{ex::sync_wait(nested(depth)).value_or(std::tuple(0u))};
+            benchmark::do_not_optimize(value);
+        },
+        depth + 1u);
+    benchmark::run(
+        "co_await just() inline (per co_await)",
+        count,
+        [awaits] {
+            auto [value]{ex::sync_wait(await_just(awaits)).value_or(std::tuple(0u))};
+            benchmark::do_not_optimize(value);
+        },
+        awaits);
+    benchmark::run(
+        "co_await just() | then() via affine (per co_await)",
+        count,
+        [awaits] {
+            auto [value]{ex::sync_wait(await_then(awaits)).value_or(std::tuple(0u))};
+            benchmark::do_not_optimize(value);
+        },
+        awaits);
+
+    ex::task_scheduler sched(ex::inline_scheduler{});
+    benchmark::run("task_scheduler schedule() round trip", count, [&sched] {
+        benchmark::do_not_optimize(ex::sync_wait(ex::schedule(sched)));
+    });
+
+    benchmark::run("co_yield with_error", count, [] {
+        auto [value]{ex::sync_wait(yield_error() | ex::upon_error([](int e) { return e; })).value_or(std::tuple(0))};
+        benchmark::do_not_optimize(value);
+    });
+    benchmark::run("exception propagation", count, [] {
+        auto [value]{ex::sync_wait(throw_error() | ex::upon_error([](std::exception_ptr) { return -1; }))
+                         .value_or(std::tuple(0))};
+        benchmark::do_not_optimize(value);
+    });
+}
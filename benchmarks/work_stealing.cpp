@@ -0,0 +1,123 @@
+// benchmarks/work_stealing.cpp                                       -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "benchmark.hpp"
+#include <beman/execution.hpp>
+#include <beman/task.hpp>
+#include <beman/task/detail/single_thread_context.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <latch>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+// Compares the throughput of fan-out workloads on the work stealing pool to
+// a run_loop processed by a single thread:
+// - "flat": all work is scheduled from the main thread.
+// - "tree": each item schedules two more items until a given depth is reached.
+
+namespace {
+auto spin(std::size_t n) -> void {
+    for (std::size_t i{}; i != n; ++i)
+        benchmark::do_not_optimize(i);
+}
+
+template <typename Scheduler>
+struct flat {
+    struct receiver {
+        using receiver_concept = ex::receiver_tag;
+        std::size_t work;
+        std::latch* done;
+        void        set_value() && noexcept {
+            spin(this->work);
+            this->done->count_down();
+        }
+        void set_stopped() && noexcept { std::terminate(); }
+    };
+    struct item {
+        decltype(ex::connect(ex::schedule(std::declval<Scheduler&>()), std::declval<receiver>())) state;
+        item(Scheduler sched, receiver r) : state(ex::connect(ex::schedule(sched), std::move(r))) {}
+    };
+
+    static auto run(Scheduler sched, std::size_t count, std::size_t work) -> void {
+        std::latch       done{std::ptrdiff_t(count)};
+        std::deque<item> items;
+        for (std::size_t i{}; i != count; ++i)
+            items.emplace_back(sched, receiver{work, &done});
+        for (auto& i : items)
+            ex::start(i.state);
+        done.wait();
+    }
+};
+
+template <typename Scheduler>
+struct tree {
+    struct node;
+    struct receiver {
+        using receiver_concept = ex::receiver_tag;
+        node* self;
+        void  set_value() && noexcept { this->self->run(); }
+        void  set_stopped() && noexcept { std::terminate(); }
+    };
+    struct node {
+        Scheduler   sched;
+        std::size_t depth;
+        std::size_t work;
+        std::latch* done;
+        decltype(ex::connect(ex::schedule(std::declval<Scheduler&>()), std::declval<receiver>())) state;
+
+        node(Scheduler s, std::size_t d, std::size_t w, std::latch* l)
+            : sched(s), depth(d), work(w), done(l), state(ex::connect(ex::schedule(this->sched), receiver{this})) {}
+        auto run() -> void {
+            if (0u < this->depth) {
+                tree::spawn(this->sched, this->depth - 1u, this->work, this->done);
+                tree::spawn(this->sched, this->depth - 1u, this->work, this->done);
+            }
+            spin(this->work);
+            std::latch* d{this->done};
+            delete this;
+            d->count_down();
+        }
+    };
+    static auto spawn(Scheduler sched, std::size_t depth, std::size_t work, std::latch* done) -> void {
+        ex::start((new node(sched, depth, work, done))->state);
+    }
+    static auto size(std::size_t depth) -> std::size_t { return (std::size_t(1u) << (depth + 1u)) - 1u; }
+
+    static auto run(Scheduler sched, std::size_t depth, std::size_t work) -> void {
+        std::latch done{std::ptrdiff_t(size(depth))};
+        spawn(sched, depth, work, &done);
+        done.wait();
+    }
+};
+
+template <typename Scheduler>
+auto measure(const std::string& name, Scheduler sched, std::size_t count, std::size_t work) -> void {
+    benchmark::run(name + " flat", count, [=] { flat<Scheduler>::run(sched, 10000u, work); }, 10000u);
+    benchmark::run(name + " tree", count, [=] { tree<Scheduler>::run(sched, 13u, work); }, tree<Scheduler>::size(13u));
+}
+} // namespace
+
+int main(int ac, char* av[]) {
+    const std::size_t count{benchmark::iterations(ac, av, 20u)};
+    const std::size_t threads{std::max(1u, std::thread::hardware_concurrency())};
+
+    for (std::size_t work : {0u, 1000u}) {
+        const std::string suffix{" (work " + std::to_string(work) + ")"};
+        {
+            bt::single_thread_context context;
+            measure("run_loop" + suffix, context.get_scheduler(), count, work);
+        }
+        {
+            beman::task::work_stealing_context context(threads);
+            measure("work_stealing x" + std::to_string(threads) + suffix, context.get_scheduler(), count, work);
+        }
+    }
+}
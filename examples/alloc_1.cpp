@@ -95,6 +95,7 @@ using a_task = ex::task<T, alloc_env>;
 
 a_task<int> hidden_async_fun(std::allocator_arg_t, ::allocator_type, int value) { co_return value; }
 auto        async_fun(int value) { return defer_frame(&hidden_async_fun)(value); }
+a_task<int> plain_async_fun(int value) { co_return value; }
 
 int main() {
     std::cout << std::unitbuf;
@@ -121,4 +122,13 @@ int main() {
                                     std::cout << "    result=" << result << "\n";
                                 })(),
                                 ex::env{ex::prop{ex::get_allocator, alloc}}));
+
+    std::cout << "setting up an allocator and creating a task without allocator argument:\n";
+    ex::sync_wait(ex::write_env(
+        []() -> a_task<> {
+            // The frame is allocated using the allocator of the running task.
+            auto result{co_await plain_async_fun(17)};
+            std::cout << "    result=" << result << "\n";
+        }(),
+        ex::env{ex::prop{ex::get_allocator, alloc}}));
 }
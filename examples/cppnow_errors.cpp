@@ -73,6 +73,22 @@ ex::task<> expected() {
     auto u = co_await as_expected(ex::just_error(17));
     print_expected("expected without value=", u);
 }
+
+struct int_error_env {
+    using error_types = ex::completion_signatures<ex::set_error_t(int)>;
+};
+ex::task<int, int_error_env> may_fail(bool fail) {
+    if (fail)
+        co_yield ex::with_error(17);
+    co_return 42;
+}
+ex::task<> task_expected() {
+    // ex::as_expected() is specific to tasks and doesn't throw or create an exception_ptr
+    auto e = co_await ex::as_expected(may_fail(false));
+    std::cout << "task expected with value=" << e.value() << "\n";
+    auto u = co_await ex::as_expected(may_fail(true));
+    std::cout << "task expected without value=" << u.error() << "\n";
+}
 #endif
 } // namespace
 
@@ -80,5 +96,6 @@ int main() {
     ex::sync_wait(error_result());
 #if 202202 <= __cpp_lib_expected
     ex::sync_wait(expected());
+    ex::sync_wait(task_expected());
 #endif
 }
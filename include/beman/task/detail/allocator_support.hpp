@@ -4,12 +4,16 @@
 #ifndef INCLUDED_BEMAN_TASK_DETAIL_ALLOCATOR_SUPPORT
 #define INCLUDED_BEMAN_TASK_DETAIL_ALLOCATOR_SUPPORT
 
-#include <beman/task/detail/find_allocator.hpp>
+#include <beman/task/detail/current_allocator.hpp>
+#if defined(BEMAN_TASK_FRAME_STATS)
+#include <beman/task/detail/frame_stats.hpp>
+#endif
 #include <array>
 #include <concepts>
 #include <cstddef>
 #include <memory>
 #include <new>
+#include <type_traits>
 
 // ----------------------------------------------------------------------------
 
@@ -20,7 +24,11 @@ namespace beman::task::detail {
  *
  * To add allocator support using this class just publicly inherit from
  * allocator_support<Allocator, YourPromiseType>. This utility is probably
- * only useful for coroutine promise types.
+ * only useful for coroutine promise types. When `BEMAN_TASK_FRAME_STATS` is
+ * defined the allocations are recorded in `frame_stats` using `Owner` to
+ * identify the allocated objects. Without a `std::allocator_arg` argument
+ * a stateful allocator is taken from the running task (see
+ * `current_allocator`).
  *
  * This struct is a massive hack, primarily support allocators for coroutines.
  * The memory for coroutines is implicitly managed and there isn't a way to
@@ -30,55 +38,104 @@ namespace beman::task::detail {
  * a pointer to delete and a size. To determine the correct allocator the
  * operator delete needs to located it based on this information. Putting
  * the allocator after actually used memory causes the address sanitizer to
- * object! So, the current strategy is to embed space for the allocator
- * into the object and pull it out from there.
+ * object! So, the current strategy is to allocate a header in front of the
+ * object and embed the allocator there. As the header only depends on the
+ * object's address the embedded allocator is also available to the object
+ * itself using `get_frame_allocator()`. Stateless allocators, i.e., empty
+ * allocators which always compare equal, are not embedded but default
+ * constructed when needed.
  */
-template <typename Allocator>
+template <typename Allocator, typename Owner = void>
 struct allocator_support {
     using allocator_traits = std::allocator_traits<Allocator>;
+    static constexpr bool stateless{::std::is_empty_v<Allocator> && ::std::default_initializable<Allocator> &&
+                                    allocator_traits::is_always_equal::value};
 
-    static std::size_t offset(std::size_t size) {
-        return (size + alignof(Allocator) - 1u) & ~(alignof(Allocator) - 1u);
-    }
-    static Allocator* get_allocator(void* ptr, std::size_t size) {
-        ptr = static_cast<std::byte*>(ptr) + offset(size);
-        return ::std::launder(reinterpret_cast<Allocator*>(ptr));
+  private:
+    struct header {
+        Allocator allocator;
+        bool      defaulted; // neither passed nor taken from the running task
+    };
+
+  public:
+    static_assert(alignof(header) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "allocator_support doesn't support over-aligned allocators");
+    static constexpr std::size_t header_size{(sizeof(header) + __STDCPP_DEFAULT_NEW_ALIGNMENT__ - 1u) &
+                                             ~(__STDCPP_DEFAULT_NEW_ALIGNMENT__ - 1u)};
+
+    /*!
+     * \brief Get the allocator embedded for the object allocated at `ptr`
+     *
+     * `ptr` needs to be the pointer returned from `operator new`. If the
+     * object was allocated using a default constructed allocator, i.e.,
+     * without a `std::allocator_arg` argument while no task with an
+     * allocator of the same type was running, the result is `nullptr`.
+     */
+    static auto get_frame_allocator(const void* ptr) noexcept -> const Allocator*
+        requires(not stateless)
+    {
+        const header* h{allocator_support::get_header(const_cast<void*>(ptr))};
+        return h->defaulted ? nullptr : &h->allocator;
     }
 
     template <typename... A>
     static void* operator new(std::size_t size, [[maybe_unused]] A&&... a) {
-        if constexpr (::std::same_as<Allocator, ::std::allocator<::std::byte>>) {
-            Allocator alloc{};
-            return allocator_traits::allocate(alloc, size);
-        } else {
-            Allocator alloc{::beman::task::detail::find_allocator<Allocator>(a...)};
-            void*     ptr{allocator_traits::allocate(alloc, allocator_support::offset(size) + sizeof(Allocator))};
-            try {
-                new (allocator_support::get_allocator(ptr, size)) Allocator(alloc);
-            } catch (...) {
-                allocator_traits::deallocate(
-                    alloc, static_cast<std::byte*>(ptr), allocator_support::offset(size) + sizeof(Allocator));
-                throw;
-            }
-            return ptr;
-        }
+        void* rc{allocator_support::allocate(size, a...)};
+#if defined(BEMAN_TASK_FRAME_STATS)
+        ::beman::task::detail::frame_stats::allocated<Owner>(size);
+#endif
+        return rc;
     }
     template <typename... A>
     static void operator delete(void* ptr, std::size_t size, const A&...) {
         allocator_support::operator delete(ptr, size);
     }
     static void operator delete(void* ptr, std::size_t size) {
-        if constexpr (::std::same_as<Allocator, ::std::allocator<::std::byte>>) {
+#if defined(BEMAN_TASK_FRAME_STATS)
+        ::beman::task::detail::frame_stats::deallocated<Owner>(size);
+#endif
+        if constexpr (allocator_support::stateless) {
             Allocator alloc{};
             allocator_traits::deallocate(alloc, static_cast<std::byte*>(ptr), size);
         } else {
-            Allocator* aptr{allocator_support::get_allocator(ptr, size)};
-            Allocator  alloc{*aptr};
-            aptr->~Allocator();
-            allocator_traits::deallocate(
-                alloc, static_cast<std::byte*>(ptr), allocator_support::offset(size) + sizeof(Allocator));
+            header*   h{allocator_support::get_header(ptr)};
+            Allocator alloc{h->allocator};
+            h->~header();
+            allocator_traits::deallocate(alloc,
+                                         static_cast<std::byte*>(ptr) - allocator_support::header_size,
+                                         allocator_support::header_size + size);
         }
     }
+
+  private:
+    template <typename... A>
+    static void* allocate(std::size_t size, [[maybe_unused]] A&... a) {
+        if constexpr (allocator_support::stateless) {
+            Allocator alloc{};
+            return allocator_traits::allocate(alloc, size);
+        } else if constexpr (::beman::task::detail::has_allocator_arg<A...>) {
+            return allocator_support::allocate_with(
+                size, ::beman::task::detail::find_allocator<Allocator>(a...), false);
+        } else {
+            if (const Allocator* current{::beman::task::detail::current_allocator<Allocator>::get()})
+                return allocator_support::allocate_with(size, *current, false);
+            return allocator_support::allocate_with(size, Allocator(), true);
+        }
+    }
+    static void* allocate_with(std::size_t size, Allocator alloc, bool defaulted) {
+        void* ptr{allocator_traits::allocate(alloc, allocator_support::header_size + size)};
+        try {
+            new (ptr) header{alloc, defaulted};
+        } catch (...) {
+            allocator_traits::deallocate(alloc, static_cast<std::byte*>(ptr), allocator_support::header_size + size);
+            throw;
+        }
+        return static_cast<std::byte*>(ptr) + allocator_support::header_size;
+    }
+    static header* get_header(void* ptr) noexcept {
+        ptr = static_cast<std::byte*>(ptr) - allocator_support::header_size;
+        return ::std::launder(reinterpret_cast<header*>(ptr));
+    }
 };
 } // namespace beman::task::detail
 
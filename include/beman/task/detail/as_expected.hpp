@@ -0,0 +1,147 @@
+// include/beman/task/detail/as_expected.hpp                          -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_AS_EXPECTED
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_AS_EXPECTED
+
+#include <beman/task/detail/awaiter.hpp>
+#include <beman/task/detail/error_types_of.hpp>
+#include <beman/task/detail/task.hpp>
+#include <beman/execution/execution.hpp>
+#include <cassert>
+#include <expected>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Utility determining the `std::expected` produced by `as_expected`
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * A single error type is used directly as the error of the `std::expected`
+ * while multiple error types are combined into an `std::variant`. Without
+ * any error type (e.g., for `noexcept_environment`) the error type is
+ * `std::monostate`, i.e., the `std::expected` always holds a value.
+ */
+template <typename Value, typename Errors>
+struct expected_of;
+template <typename Value>
+struct expected_of<Value, ::beman::execution::completion_signatures<>> {
+    using type = ::std::expected<Value, ::std::monostate>;
+};
+template <typename Value, typename Error>
+struct expected_of<Value, ::beman::execution::completion_signatures<::beman::execution::set_error_t(Error)>> {
+    using type = ::std::expected<Value, Error>;
+};
+template <typename Value, typename E0, typename E1, typename... E>
+struct expected_of<Value,
+                   ::beman::execution::completion_signatures<::beman::execution::set_error_t(E0),
+                                                             ::beman::execution::set_error_t(E1),
+                                                             ::beman::execution::set_error_t(E)...>> {
+    using type = ::std::expected<Value, ::std::variant<E0, E1, E...>>;
+};
+template <typename Value, typename Errors>
+using expected_of_t = typename ::beman::task::detail::expected_of<Value, Errors>::type;
+
+/*!
+ * \brief Awaiter for a task producing its result as `std::expected`
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * The awaiter behaves like the awaiter for the task except that
+ * `await_resume()` returns the stored result without throwing: an error
+ * reported by the task becomes the error of the `std::expected`. Errors
+ * reported using `co_yield with_error(e)` never involve an exception.
+ */
+template <typename Value, typename Env, typename OwnPromise, typename ParentPromise>
+class expected_awaiter : public ::beman::task::detail::awaiter<Value, Env, OwnPromise, ParentPromise> {
+  public:
+    using expected_type = ::beman::task::detail::expected_of_t<Value, ::beman::task::detail::error_types_of_t<Env>>;
+
+    using ::beman::task::detail::awaiter<Value, Env, OwnPromise, ParentPromise>::awaiter;
+    auto await_resume() -> expected_type { return this->template result_expected<expected_type>(); }
+};
+
+/*!
+ * \brief Sender adapting a task to complete with an `std::expected`
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * When `co_await`ed by another task the task's awaiter is used directly,
+ * i.e., there is no additional sender machinery involved. Otherwise the
+ * task's completions are transformed using `then` and `upon_error`.
+ */
+template <typename Task>
+class expected_sender;
+template <typename Value, typename Env>
+class expected_sender<::beman::task::detail::task<Value, Env>> {
+  private:
+    using task_type     = ::beman::task::detail::task<Value, Env>;
+    using expected_type = ::beman::task::detail::expected_of_t<Value, ::beman::task::detail::error_types_of_t<Env>>;
+    template <typename ParentPromise>
+    using awaiter = ::beman::task::detail::
+        expected_awaiter<Value, Env, ::beman::task::detail::promise_type<task_type, Value, Env>, ParentPromise>;
+
+  public:
+    using sender_concept        = ::beman::execution::sender_tag;
+    using completion_signatures = ::beman::execution::completion_signatures<
+        ::beman::execution::set_value_t(expected_type),
+        ::beman::execution::set_stopped_t()>;
+    template <typename Ev>
+    auto get_completion_signatures(const Ev&) const& noexcept -> completion_signatures {
+        return {};
+    }
+    template <typename...>
+    static consteval auto get_completion_signatures() noexcept -> completion_signatures {
+        return {};
+    }
+
+    explicit expected_sender(task_type&& t) noexcept : task(::std::move(t)) {}
+
+    template <typename Receiver>
+    auto connect(Receiver&& receiver) && {
+        return ::beman::execution::connect(
+            ::beman::execution::upon_error(
+                ::beman::execution::then(::std::move(this->task),
+                                         []<typename... A>(A&&... a) noexcept {
+                                             return expected_type(::std::in_place, ::std::forward<A>(a)...);
+                                         }),
+                []<typename E>(E&& error) noexcept {
+                    return expected_type(::std::unexpect, ::std::forward<E>(error));
+                }),
+            ::std::forward<Receiver>(receiver));
+    }
+    template <typename ParentPromise>
+    auto as_awaitable(ParentPromise& parent) && -> awaiter<ParentPromise> {
+        assert(this->task.handle.get());
+        return awaiter<ParentPromise>(::std::move(this->task.handle), parent);
+    }
+
+  private:
+    task_type task;
+};
+
+/*!
+ * \brief Adaptor turning a task into a sender completing with an `std::expected`
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * Using `co_await as_expected(t)` yields an `std::expected` holding either
+ * the value or the error produced by the task `t` instead of throwing the
+ * error. A stopped task still doesn't resume the awaiting coroutine.
+ */
+inline constexpr struct as_expected_t {
+    template <typename Value, typename Env>
+    auto operator()(::beman::task::detail::task<Value, Env>&& t) const
+        -> ::beman::task::detail::expected_sender<::beman::task::detail::task<Value, Env>> {
+        return ::beman::task::detail::expected_sender<::beman::task::detail::task<Value, Env>>(::std::move(t));
+    }
+} as_expected{};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
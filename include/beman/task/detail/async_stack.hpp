@@ -0,0 +1,263 @@
+// include/beman/task/detail/async_stack.hpp                          -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_ASYNC_STACK
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_ASYNC_STACK
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <source_location>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Registry of live tasks used to show the chains of awaiting tasks
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * When `BEMAN_TASK_ASYNC_STACK` is defined (consistently for all
+ * translation units) each task's promise embeds an `async_stack_node`
+ * which is linked into a process-wide list while the coroutine frame
+ * exists. The node records the task awaiting it (if any), the source
+ * location of the most recent `co_await`, and whether the task is
+ * currently suspended on that `co_await`. The registry can be inspected
+ * using `snapshot()` or `dump()`. The overload of `dump()` writing into a
+ * caller-provided buffer doesn't allocate and doesn't block, i.e., it can
+ * be used from a signal handler (the result can be written using
+ * `write(2)`). Without the macro the node is empty and nothing is
+ * recorded.
+ */
+class async_stack {
+  public:
+#if defined(BEMAN_TASK_ASYNC_STACK)
+    static constexpr bool enabled{true};
+#else
+    static constexpr bool enabled{false};
+#endif
+
+    /*!
+     * \brief Information about one live task
+     */
+    struct frame {
+        const void*   task{};      //!< address of the task's promise
+        const void*   parent{};    //!< address of the awaiting task's promise or null
+        const char*   file{};      //!< file of the most recent `co_await` or null
+        const char*   function{};  //!< function of the most recent `co_await` or null
+        std::uint32_t line{};      //!< line of the most recent `co_await`
+        bool          suspended{}; //!< whether the task is suspended on that `co_await`
+    };
+
+    /*!
+     * \brief Get the information about all live tasks
+     */
+    static auto snapshot() -> std::vector<frame> {
+        std::vector<frame> rc;
+        lock_guard         cerberus(true);
+        for (const node* n{async_stack::get_head().next}; n != &async_stack::get_head(); n = n->next)
+            rc.push_back(n->get_frame());
+        return rc;
+    }
+    /*!
+     * \brief Write the chains of awaiting tasks to `out`
+     */
+    static auto dump(std::ostream& out) -> void {
+        const std::vector<frame> frames{async_stack::snapshot()};
+        for (const frame& f : frames) {
+            if (async_stack::is_parent(frames.begin(), frames.end(), f.task))
+                continue;
+            const char* prefix{"task "};
+            for (const frame* c{&f}; c; c = async_stack::find(frames.begin(), frames.end(), c->parent)) {
+                out << prefix << c->task << (c->suspended ? " suspended at " : " last co_await at ")
+                    << (c->file ? c->file : "?") << ":" << c->line << " (" << (c->function ? c->function : "?")
+                    << ")\n";
+                prefix = "  awaited by ";
+            }
+        }
+    }
+    /*!
+     * \brief Write the chains of awaiting tasks into `buffer` without allocating or blocking
+     *
+     * Returns the number of characters written. If the registry is
+     * currently modified by another thread nothing is written.
+     */
+    static auto dump(char* buffer, std::size_t size) noexcept -> std::size_t {
+        lock_guard cerberus(false);
+        if (not cerberus.locked)
+            return 0u;
+        writer      w{buffer, size};
+        const node* head{&async_stack::get_head()};
+        for (const node* n{head->next}; n != head; n = n->next) {
+            if (async_stack::is_parent(node_iterator{head->next}, node_iterator{head}, n->task))
+                continue;
+            const char* prefix{"task "};
+            for (const node* c{n}; c; c = c->parent.load(std::memory_order_relaxed)) {
+                const frame f{c->get_frame()};
+                w.text(prefix);
+                w.pointer(f.task);
+                w.text(f.suspended ? " suspended at " : " last co_await at ");
+                w.text(f.file ? f.file : "?");
+                w.text(":");
+                w.number(f.line);
+                w.text(" (");
+                w.text(f.function ? f.function : "?");
+                w.text(")\n");
+                prefix = "  awaited by ";
+            }
+        }
+        return w.used;
+    }
+
+  private:
+    friend class async_stack_node;
+    struct node {
+        node*                            prev{this};
+        node*                            next{this};
+        const void*                      task{};
+        std::atomic<const node*>         parent{};
+        std::atomic<const char*>         file{};
+        std::atomic<const char*>         function{};
+        std::atomic<std::uint_least32_t> line{};
+        std::atomic<bool>                suspended{};
+
+        auto get_frame() const noexcept -> frame {
+            const node* p{this->parent.load(std::memory_order_relaxed)};
+            return frame{this->task,
+                         p ? p->task : nullptr,
+                         this->file.load(std::memory_order_relaxed),
+                         this->function.load(std::memory_order_relaxed),
+                         std::uint32_t(this->line.load(std::memory_order_relaxed)),
+                         this->suspended.load(std::memory_order_relaxed)};
+        }
+    };
+    struct node_iterator {
+        const node* n;
+        auto        operator*() const noexcept -> frame { return n->get_frame(); }
+        auto        operator++() noexcept -> node_iterator& {
+            this->n = this->n->next;
+            return *this;
+        }
+        auto operator==(const node_iterator&) const -> bool = default;
+    };
+    // Spin lock as the lock may need to be acquired from a signal handler using try_lock.
+    struct lock_guard {
+        bool locked{};
+        explicit lock_guard(bool wait) noexcept {
+            while (not(this->locked = not async_stack::get_lock().test_and_set(std::memory_order_acquire)) && wait)
+                async_stack::get_lock().wait(true, std::memory_order_relaxed);
+        }
+        lock_guard(lock_guard&&) = delete;
+        ~lock_guard() {
+            if (this->locked) {
+                async_stack::get_lock().clear(std::memory_order_release);
+                async_stack::get_lock().notify_one();
+            }
+        }
+    };
+    struct writer {
+        char*       buffer;
+        std::size_t size;
+        std::size_t used{};
+        auto        text(std::string_view s) noexcept -> void {
+            for (char c : s)
+                if (this->used != this->size)
+                    this->buffer[this->used++] = c;
+        }
+        auto number(std::uint32_t value) noexcept -> void {
+            char  digits[10];
+            char* it{digits + sizeof(digits)};
+            do {
+                *--it = char('0' + value % 10u);
+            } while (value /= 10u);
+            this->text(std::string_view(it, std::size_t(digits + sizeof(digits) - it)));
+        }
+        auto pointer(const void* ptr) noexcept -> void {
+            char           digits[2u * sizeof(void*)];
+            std::uintptr_t value{reinterpret_cast<std::uintptr_t>(ptr)};
+            for (std::size_t i{sizeof(digits)}; i-- != 0u; value >>= 4u)
+                digits[i] = "0123456789abcdef"[value & 0xfu];
+            this->text("0x");
+            this->text(std::string_view(digits, sizeof(digits)));
+        }
+    };
+
+    template <typename It>
+    static auto is_parent(It it, It end, const void* task) -> bool {
+        for (; it != end; ++it)
+            if ((*it).parent == task)
+                return true;
+        return false;
+    }
+    template <typename It>
+    static auto find(It it, It end, const void* task) -> const frame* {
+        for (; task && it != end; ++it)
+            if (it->task == task)
+                return &*it;
+        return nullptr;
+    }
+    static auto get_head() noexcept -> node& {
+        static node head;
+        return head;
+    }
+    static auto get_lock() noexcept -> std::atomic_flag& {
+        static std::atomic_flag rc{};
+        return rc;
+    }
+};
+
+#if defined(BEMAN_TASK_ASYNC_STACK)
+/*!
+ * \brief Node of the live task registry embedded into a task's promise
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ */
+class async_stack_node {
+  public:
+    explicit async_stack_node(const void* task) noexcept {
+        this->n.task = task;
+        async_stack::lock_guard cerberus(true);
+        async_stack::node&      head{async_stack::get_head()};
+        this->n.prev    = &head;
+        this->n.next    = head.next;
+        head.next->prev = &this->n;
+        head.next       = &this->n;
+    }
+    async_stack_node(async_stack_node&&) = delete;
+    ~async_stack_node() {
+        async_stack::lock_guard cerberus(true);
+        this->n.prev->next = this->n.next;
+        this->n.next->prev = this->n.prev;
+    }
+
+    auto set_parent(const async_stack_node* parent) noexcept -> void {
+        this->n.parent.store(parent ? &parent->n : nullptr, std::memory_order_relaxed);
+    }
+    auto set_site(const std::source_location& site) noexcept -> void {
+        this->n.file.store(site.file_name(), std::memory_order_relaxed);
+        this->n.function.store(site.function_name(), std::memory_order_relaxed);
+        this->n.line.store(site.line(), std::memory_order_relaxed);
+    }
+    auto set_suspended(bool value) noexcept -> void { this->n.suspended.store(value, std::memory_order_relaxed); }
+
+  private:
+    async_stack::node n;
+};
+#else
+class async_stack_node {
+  public:
+    explicit async_stack_node(const void*) noexcept {}
+    async_stack_node(async_stack_node&&) = delete;
+
+    auto set_parent(const async_stack_node*) noexcept -> void {}
+    auto set_site(const std::source_location&) noexcept -> void {}
+    auto set_suspended(bool) noexcept -> void {}
+};
+#endif
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
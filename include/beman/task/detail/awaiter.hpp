@@ -4,10 +4,17 @@
 #ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_AWAITER
 #define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_AWAITER
 
+#include <beman/task/detail/can_run_inline.hpp>
+#include <beman/task/detail/eager_start_of.hpp>
 #include <beman/task/detail/handle.hpp>
 #include <beman/task/detail/state_base.hpp>
 #include <beman/task/detail/state_rep.hpp>
+#include <beman/task/detail/stop_forward.hpp>
+#include <beman/task/detail/trace.hpp>
+#include <atomic>
+#include <concepts>
 #include <coroutine>
+#include <type_traits>
 #include <utility>
 
 // ----------------------------------------------------------------------------
@@ -48,36 +55,95 @@ struct awaiter_op_t<Awaiter, ParentPromise, false> {
 template <typename Value, typename Env, typename OwnPromise, typename ParentPromise>
 class awaiter : public ::beman::task::detail::state_base<Value, Env> {
   public:
-    using allocator_type  = typename ::beman::task::detail::state_base<Value, Env>::allocator_type;
-    using stop_token_type = typename ::beman::task::detail::state_base<Value, Env>::stop_token_type;
-    using scheduler_type  = typename ::beman::task::detail::state_base<Value, Env>::scheduler_type;
+    using allocator_type   = typename ::beman::task::detail::state_base<Value, Env>::allocator_type;
+    using stop_source_type = typename ::beman::task::detail::state_base<Value, Env>::stop_source_type;
+    using stop_token_type  = typename ::beman::task::detail::state_base<Value, Env>::stop_token_type;
+    using scheduler_type   = typename ::beman::task::detail::state_base<Value, Env>::scheduler_type;
 
-    explicit awaiter(::beman::task::detail::handle<OwnPromise> h) : handle(std::move(h)) {}
-    constexpr auto await_ready() const noexcept -> bool { return false; }
+    awaiter(::beman::task::detail::handle<OwnPromise> h, ParentPromise& p)
+        : ::beman::task::detail::state_base<Value, Env>(this), handle(std::move(h)), parent_promise(&p) {}
+    auto await_ready() noexcept -> bool {
+        if constexpr (eager) {
+            this->bind_parent(*this->parent_promise);
+            this->handle.start(this).resume();
+            // A stopped task needs the suspended parent to call unhandled_stopped().
+            return this->ready.load(::std::memory_order_acquire) && not this->no_completion_set();
+        } else
+            return false;
+    }
     struct env_receiver {
         ParentPromise* parent;
         auto           get_env() const noexcept { return parent->get_env(); }
     };
-    auto await_suspend(::std::coroutine_handle<ParentPromise> parent) noexcept {
-        this->state_rep.emplace(env_receiver{&parent.promise()});
-        this->scheduler.emplace(
-            this->template from_env<scheduler_type>(::beman::execution::get_env(parent.promise())));
-        this->parent = ::std::move(parent);
-        return this->handle.start(this);
+    auto await_suspend(::std::coroutine_handle<ParentPromise> parent) noexcept -> ::std::coroutine_handle<> {
+        if constexpr (eager) {
+            // Whoever of the parent and the task arrives second continues the parent.
+            this->parent = ::std::move(parent);
+            if (this->ready.exchange(true, ::std::memory_order_acq_rel))
+                return this->actual_complete();
+            return ::std::noop_coroutine();
+        } else {
+            this->bind_parent(parent.promise());
+            this->parent = ::std::move(parent);
+            return this->handle.start(this);
+        }
     }
     auto await_resume() { return this->result_resume(); }
 
   private:
+    friend class ::beman::task::detail::state_base<Value, Env>;
     friend struct awaiter_scheduler_receiver<awaiter>;
-    auto do_complete() -> std::coroutine_handle<> override {
+    // If the scheduler is initialized from the parent's start scheduler and
+    // is never changed the parent can be resumed without any comparison.
+    static constexpr bool inherits_scheduler{requires(const ParentPromise& p) {
+        scheduler_type(::beman::execution::get_start_scheduler(::beman::execution::get_env(p)));
+    }};
+    // The parent's stop token is used directly if it has the right type.
+    // Otherwise stop requests are forwarded via a stop source which is only
+    // created when a stop token is requested.
+    using parent_token_t = ::std::remove_cvref_t<decltype(::beman::execution::get_stop_token(
+        ::beman::execution::get_env(::std::declval<const ParentPromise&>())))>;
+    using stop_forward_t = ::beman::task::detail::stop_forward<parent_token_t, stop_source_type>;
+    static constexpr bool shares_stop_token{::std::same_as<parent_token_t, stop_token_type>};
+    // An eager task is already resumed from await_ready() and may complete
+    // before the parent suspended, possibly on a different thread.
+    static constexpr bool eager{::beman::task::detail::eager_start_of_v<Env>};
+    struct no_flag {};
+    using ready_t = ::std::conditional_t<eager, ::std::atomic<bool>, no_flag>;
+
+    auto bind_parent(ParentPromise& p) noexcept -> void {
+        this->state_rep.emplace(env_receiver{&p});
+        this->scheduler.emplace(this->template from_env<scheduler_type>(::beman::execution::get_env(p)));
+        this->bind(*this->scheduler, this->state_rep->context);
+        if constexpr (shares_stop_token) {
+            this->token = ::beman::execution::get_stop_token(::beman::execution::get_env(p));
+            this->bind_stop_token(this->token);
+        }
+        if constexpr (requires { p.get_async_stack_node(); })
+            this->handle.get()->get_async_stack_node().set_parent(&p.get_async_stack_node());
+    }
+
+    auto do_complete() -> std::coroutine_handle<> {
+        if constexpr (eager) {
+            if (not this->ready.exchange(true, ::std::memory_order_acq_rel))
+                return ::std::noop_coroutine();
+        }
         assert(this->parent);
         assert(this->scheduler);
         if constexpr (requires {
                           *this->scheduler != ::beman::execution::get_start_scheduler(
                                                   ::beman::execution::get_env(this->parent.promise()));
                       }) {
-            if (*this->scheduler !=
-                ::beman::execution::get_start_scheduler(::beman::execution::get_env(this->parent.promise()))) {
+            if constexpr (inherits_scheduler) {
+                if (not this->start_scheduler_changed())
+                    return this->actual_complete();
+            }
+            const auto& parent_scheduler{
+                ::beman::execution::get_start_scheduler(::beman::execution::get_env(this->parent.promise()))};
+            // The parent can be resumed directly if its scheduler runs work on the current thread anyway.
+            if (*this->scheduler != parent_scheduler && not ::beman::task::detail::can_run_inline(parent_scheduler)) {
+                ::beman::task::detail::trace::emit(::beman::task::detail::trace_event::reschedule,
+                                                   &this->parent.promise());
                 this->reschedule.emplace(this->parent.promise(), this);
                 this->reschedule->start();
                 return ::std::noop_coroutine();
@@ -88,7 +154,7 @@ class awaiter : public ::beman::task::detail::state_base<Value, Env> {
     auto actual_complete() -> std::coroutine_handle<> {
         return this->no_completion_set() ? this->parent.promise().unhandled_stopped() : ::std::move(this->parent);
     }
-    auto do_get_allocator() -> allocator_type override {
+    auto do_get_allocator() -> allocator_type {
         if constexpr (requires {
                           ::beman::execution::get_allocator(::beman::execution::get_env(this->parent.promise()));
                       })
@@ -96,18 +162,29 @@ class awaiter : public ::beman::task::detail::state_base<Value, Env> {
         else
             return allocator_type{};
     }
-    auto do_get_start_scheduler() -> scheduler_type override { return *this->scheduler; }
-    auto do_set_start_scheduler(scheduler_type other) -> scheduler_type override {
-        return ::std::exchange(*this->scheduler, other);
+    // A parent task with the same allocator type shares the allocator it makes available.
+    auto do_get_allocator_ptr() const noexcept -> const allocator_type*
+        requires requires(const ParentPromise& p) {
+            { p.get_allocator_ptr() } -> ::std::same_as<const allocator_type*>;
+        }
+    {
+        return this->parent_promise->get_allocator_ptr();
+    }
+    auto do_get_stop_token() -> stop_token_type {
+        assert(this->parent);
+        return this->stop.get_token(
+            ::beman::execution::get_stop_token(::beman::execution::get_env(this->parent.promise())));
     }
-    auto do_get_stop_token() -> stop_token_type override { return {}; }
-    auto do_get_environment() -> Env& override { return this->state_rep->context; }
 
     ::beman::task::detail::handle<OwnPromise>                            handle;
+    ParentPromise*                                                       parent_promise;
     ::std::optional<::beman::task::detail::state_rep<Env, env_receiver>> state_rep;
     ::std::optional<scheduler_type>                                      scheduler;
+    stop_token_type                                                      token{};
+    [[no_unique_address]] stop_forward_t                                 stop;
     ::std::coroutine_handle<ParentPromise>                               parent{};
     ::std::optional<awaiter_op_t<awaiter, ParentPromise>>                reschedule{};
+    [[no_unique_address]] ready_t                                        ready{};
 };
 } // namespace beman::task::detail
 
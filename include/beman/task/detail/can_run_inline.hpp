@@ -0,0 +1,75 @@
+// include/beman/task/detail/can_run_inline.hpp                       -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_CAN_RUN_INLINE
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_CAN_RUN_INLINE
+
+#include <beman/execution/execution.hpp>
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Record the `run_loop` run by the current thread
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * While an object of this type exists the current thread is considered to
+ * be the thread running `loop`, i.e., `can_run_inline` reports `true` for
+ * the loop's scheduler. It is meant to surround a call to `loop.run()`.
+ * Scopes can be nested: the previous loop is restored on destruction.
+ */
+class run_loop_scope {
+  public:
+    explicit run_loop_scope(::beman::execution::run_loop& loop) noexcept
+        : previous(::std::exchange(run_loop_scope::current(), &loop)) {}
+    run_loop_scope(run_loop_scope&&) = delete;
+    ~run_loop_scope() { run_loop_scope::current() = this->previous; }
+
+    static auto get() noexcept -> ::beman::execution::run_loop* { return run_loop_scope::current(); }
+
+  private:
+    static auto current() noexcept -> ::beman::execution::run_loop*& {
+        static thread_local ::beman::execution::run_loop* rc{};
+        return rc;
+    }
+
+    ::beman::execution::run_loop* previous;
+};
+
+/*!
+ * \brief Query whether work for a scheduler can be executed directly on the current thread
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * A scheduler can answer the query using a member `query(can_run_inline_t)`.
+ * The answer for the `inline_scheduler` is always `true` and for the
+ * scheduler of a `run_loop` it is `true` when the current thread runs the
+ * loop within a `run_loop_scope`. For all other schedulers the answer is
+ * `false`. When the answer is `true` an awaiting task is resumed without
+ * scheduling it on the scheduler.
+ */
+struct can_run_inline_t {
+    template <typename Scheduler>
+    auto operator()(const Scheduler& sched) const noexcept -> bool {
+        using run_loop_scheduler = decltype(::std::declval<::beman::execution::run_loop&>().get_scheduler());
+        if constexpr (requires {
+                          { sched.query(*this) } noexcept -> ::std::same_as<bool>;
+                      })
+            return sched.query(*this);
+        else if constexpr (::std::same_as<Scheduler, ::beman::execution::inline_scheduler>)
+            return true;
+        else if constexpr (::std::same_as<Scheduler, run_loop_scheduler>) {
+            ::beman::execution::run_loop* loop{::beman::task::detail::run_loop_scope::get()};
+            return loop && loop->get_scheduler() == sched;
+        } else
+            return false;
+    }
+};
+inline constexpr can_run_inline_t can_run_inline{};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,100 @@
+// include/beman/task/detail/chunked_bulk.hpp                         -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_CHUNKED_BULK
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_CHUNKED_BULK
+
+#include <beman/execution/execution.hpp>
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Query the number of threads which may process a scheduler's work concurrently
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * A scheduler can answer the query using a member `query(parallelism_t)`.
+ * Schedulers without such a member, e.g., the `inline_scheduler` or the
+ * scheduler of a `run_loop`, are assumed to process work sequentially.
+ * Only schedulers whose domain transforms `bulk` to process chunks
+ * concurrently should report more than one thread: with the default `bulk`
+ * the chunks are processed one after the other anyway.
+ */
+struct parallelism_t {
+    template <typename Scheduler>
+    auto operator()(const Scheduler& sched) const noexcept -> std::size_t {
+        if constexpr (requires {
+                          { sched.query(*this) } noexcept -> ::std::convertible_to<std::size_t>;
+                      })
+            return std::max(std::size_t(1u), std::size_t(sched.query(*this)));
+        else
+            return 1u;
+    }
+};
+inline constexpr parallelism_t parallelism{};
+
+/*!
+ * \brief Determine the number of chunks used to process `shape` indices
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * A few chunks per thread allow some load balancing without processing
+ * each index individually.
+ */
+inline auto chunk_count(std::size_t shape, std::size_t parallelism) noexcept -> std::size_t {
+    return std::min(shape, 4u * std::max(std::size_t(1u), parallelism));
+}
+
+/*!
+ * \brief Determine the index range `[begin, end)` processed by chunk `index`
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ */
+inline auto chunk_range(std::size_t index, std::size_t shape, std::size_t chunks) noexcept
+    -> std::pair<std::size_t, std::size_t> {
+    const std::size_t size{shape / chunks};
+    const std::size_t extra{shape % chunks};
+    const std::size_t begin{index * size + std::min(index, extra)};
+    return {begin, begin + size + (index < extra ? 1u : 0u)};
+}
+
+/*!
+ * \brief Turn a `bulk` sender into a sender using a chunked bulk implementation
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * The sender `sndr` is a `bulk(child, shape, fun)` sender. `select(child)`
+ * is called to obtain a factory `make`: `make(shape, body)` needs to return
+ * a sender completing with `set_value_t()` after calling `body(begin, end)`
+ * for chunks of indices covering `[0, shape)`. The resulting sender
+ * completes with the values of `child` after `fun(i, values...)` was
+ * called for all indices `i`.
+ */
+template <::beman::execution::sender Sndr, typename Select>
+auto chunked_bulk(Sndr&& sndr, Select select) {
+    auto [tag, data, child] = ::std::forward<Sndr>(sndr);
+    auto [shape, fun]       = ::std::move(data);
+    using shape_t           = decltype(shape);
+    auto make{select(::std::as_const(child))};
+    return ::beman::execution::let_value(
+        ::std::move(child),
+        [count = ::std::size_t(shape), fun = ::std::move(fun), make = ::std::move(make)](auto&... values) mutable {
+            return ::beman::execution::let_value(
+                make(count,
+                     [&fun, &values...](::std::size_t begin, ::std::size_t end) {
+                         for (; begin != end; ++begin)
+                             fun(shape_t(begin), values...);
+                     }),
+                [&values...] { return ::beman::execution::just(::std::move(values)...); });
+        });
+}
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
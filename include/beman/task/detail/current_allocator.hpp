@@ -0,0 +1,74 @@
+// include/beman/task/detail/current_allocator.hpp                    -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_CURRENT_ALLOCATOR
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_CURRENT_ALLOCATOR
+
+#include <beman/task/detail/find_allocator.hpp>
+#include <concepts>
+#include <memory>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Thread-local allocator of the coroutine currently running on a thread
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * A task using a stateful allocator sets the pointer to its allocator
+ * whenever it is resumed and restores the previous pointer whenever it
+ * suspends. A task created while another task with the same allocator
+ * type is running and without an explicit `std::allocator_arg` argument
+ * allocates its frame using the running task's allocator. That way a whole
+ * tree of tasks uses the allocator passed to the outermost task or
+ * provided by the outermost task's environment.
+ *
+ * The inherited allocator is only guaranteed to stay usable while the
+ * creating task runs, i.e., for tasks which are `co_await`ed. Tasks which
+ * are started detached (e.g., using `spawn` or `start_detached`) may
+ * outlive the creating task and should get their allocator explicitly
+ * using `std::allocator_arg`: otherwise their frame may, e.g., be allocated
+ * from an arena which is reset while they still run.
+ *
+ * The allocator is inherited independent of the thread or scheduler the
+ * created task runs on: a task resumed on another thread still uses it for
+ * the tasks it creates and its frame is released on that thread. Allocators
+ * which aren't thread-safe, like `frame_arena_allocator`, must therefore
+ * only be used for task trees running on one thread at a time. Tasks which
+ * run concurrently, e.g., using `when_all` on a thread pool, should get a
+ * thread-safe allocator explicitly.
+ */
+template <typename Allocator>
+class current_allocator {
+  public:
+    static auto get() noexcept -> const Allocator* { return current_allocator::current; }
+    static auto set(const Allocator* alloc) noexcept -> void { current_allocator::current = alloc; }
+
+  private:
+    static inline thread_local const Allocator* current{};
+};
+
+template <typename... A>
+inline constexpr bool has_allocator_arg{(::std::same_as<::std::remove_cvref_t<A>, ::std::allocator_arg_t> || ...)};
+
+/*!
+ * \brief Get the allocator for a coroutine frame from the arguments or the running task
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ */
+template <typename Allocator, typename... A>
+auto find_frame_allocator(const A&... a) -> Allocator {
+    if constexpr (::beman::task::detail::has_allocator_arg<A...>)
+        return ::beman::task::detail::find_allocator<Allocator>(a...);
+    else if (const Allocator* current{::beman::task::detail::current_allocator<Allocator>::get()})
+        return *current;
+    else
+        return Allocator();
+}
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
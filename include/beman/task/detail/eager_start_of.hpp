@@ -0,0 +1,33 @@
+// include/beman/task/detail/eager_start_of.hpp                       -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_EAGER_START_OF
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_EAGER_START_OF
+
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Utility to determine whether a context asks for eagerly started tasks
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * A context can define `static constexpr bool eager_start{true};` to
+ * request that a `co_await`ed task is run until its first suspension
+ * already from `await_ready()`. If it completes synchronously the
+ * awaiting coroutine doesn't suspend at all.
+ */
+template <typename>
+struct eager_start_of : ::std::false_type {};
+template <typename Context>
+    requires requires { typename ::std::bool_constant<bool(Context::eager_start)>; }
+struct eager_start_of<Context> : ::std::bool_constant<bool(Context::eager_start)> {};
+template <typename Context>
+inline constexpr bool eager_start_of_v{::beman::task::detail::eager_start_of<Context>::value};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
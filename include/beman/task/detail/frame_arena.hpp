@@ -0,0 +1,155 @@
+// include/beman/task/detail/frame_arena.hpp                          -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_BEMAN_TASK_DETAIL_FRAME_ARENA
+#define INCLUDED_BEMAN_TASK_DETAIL_FRAME_ARENA
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Bump-pointer arena for coroutine frames which are released together
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * Memory is carved from chunks of at least `chunk_size` bytes obtained
+ * from the global heap. Deallocation doesn't do anything: the memory is
+ * only reclaimed by `reset()` (which requires that no object allocated
+ * from the arena is alive anymore) or when the arena is destroyed. A
+ * typical use creates an arena per request and uses it for all tasks
+ * handling the request. The arena isn't thread-safe: allocations from
+ * the same arena can't be made concurrently.
+ */
+class frame_arena {
+  public:
+    static constexpr std::size_t alignment{__STDCPP_DEFAULT_NEW_ALIGNMENT__};
+    static constexpr std::size_t default_chunk_size{std::size_t(1u) << 16u};
+
+    /*!
+     * \brief Counters describing the arena's use
+     */
+    struct stats {
+        std::size_t allocations{}; //!< number of allocations since the last reset
+        std::size_t bytes{};       //!< number of bytes allocated since the last reset
+        std::size_t chunks{};      //!< number of chunks currently owned
+    };
+
+    explicit frame_arena(std::size_t chunk = default_chunk_size) noexcept : chunk_size(chunk) {}
+    frame_arena(frame_arena&&) = delete;
+    ~frame_arena() { this->release(nullptr); }
+
+    auto allocate(std::size_t size) -> void* {
+        size = frame_arena::rounded(size);
+        if (this->available < size)
+            this->grow(size);
+        void* rc{this->next};
+        this->next += size;
+        this->available -= size;
+        ++this->counters.allocations;
+        this->counters.bytes += size;
+        return rc;
+    }
+    static auto deallocate(void*, std::size_t) noexcept -> void {}
+
+    /*!
+     * \brief Make all memory available again, keeping only the most recent chunk
+     */
+    auto reset() noexcept -> void {
+        this->release(this->head);
+        this->counters = stats{0u, 0u, this->head ? 1u : 0u};
+        if (this->head) {
+            this->next      = this->head->data();
+            this->available = this->head->size;
+        }
+    }
+    auto get_stats() const noexcept -> stats { return this->counters; }
+
+  private:
+    struct chunk {
+        chunk*      link;
+        std::size_t size;
+        auto        data() noexcept -> std::byte* {
+            return reinterpret_cast<std::byte*>(this) + frame_arena::rounded(sizeof(chunk));
+        }
+    };
+
+    static constexpr auto rounded(std::size_t size) noexcept -> std::size_t {
+        return (size + alignment - 1u) & ~(alignment - 1u);
+    }
+    auto grow(std::size_t size) -> void {
+        const std::size_t capacity{std::max(this->chunk_size, size)};
+        void*             raw{::operator new(frame_arena::rounded(sizeof(chunk)) + capacity)};
+        this->head      = ::new (raw) chunk{this->head, capacity};
+        this->next      = this->head->data();
+        this->available = capacity;
+        ++this->counters.chunks;
+    }
+    // Release all chunks except keep.
+    auto release(chunk* keep) noexcept -> void {
+        for (chunk* c{keep ? keep->link : this->head}; c;) {
+            chunk* link{c->link};
+            ::operator delete(c, frame_arena::rounded(sizeof(chunk)) + c->size);
+            c = link;
+        }
+        if (keep)
+            keep->link = nullptr;
+    }
+
+    std::size_t chunk_size;
+    chunk*      head{};
+    std::byte*  next{};
+    std::size_t available{};
+    stats       counters{};
+};
+
+/*!
+ * \brief Allocator using a frame_arena
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * Using this allocator as `allocator_type` of a task's environment and
+ * passing it using `std::allocator_arg` causes the coroutine frames to be
+ * allocated from the arena. The allocator only consists of a pointer to
+ * the arena, i.e., only a pointer is stored in each coroutine frame. A
+ * default constructed allocator doesn't refer to an arena and uses the
+ * global heap. Tasks created without an allocator argument while a task
+ * using the arena runs also allocate their frames from the arena. Tasks
+ * which are started detached need to get an allocator explicitly as they
+ * may still run when the arena is reset. As the arena isn't thread-safe,
+ * the same applies to tasks running concurrently on other threads (see
+ * `current_allocator`).
+ */
+template <typename T = ::std::byte>
+struct frame_arena_allocator {
+    static_assert(alignof(T) <= ::beman::task::detail::frame_arena::alignment,
+                  "frame_arena_allocator doesn't support over-aligned types");
+    using value_type = T;
+
+    frame_arena_allocator() = default;
+    constexpr frame_arena_allocator(::beman::task::detail::frame_arena& a) noexcept : arena(&a) {}
+    template <typename U>
+    constexpr frame_arena_allocator(const frame_arena_allocator<U>& other) noexcept : arena(other.arena) {}
+
+    auto allocate(::std::size_t n) -> T* {
+        return static_cast<T*>(this->arena ? this->arena->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+    auto deallocate(T* ptr, ::std::size_t n) noexcept -> void {
+        if (not this->arena)
+            ::operator delete(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    constexpr auto operator==(const frame_arena_allocator<U>& other) const noexcept -> bool {
+        return this->arena == other.arena;
+    }
+
+    ::beman::task::detail::frame_arena* arena{};
+};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
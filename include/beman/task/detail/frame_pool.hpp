@@ -0,0 +1,178 @@
+// include/beman/task/detail/frame_pool.hpp                           -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_BEMAN_TASK_DETAIL_FRAME_POOL
+#define INCLUDED_BEMAN_TASK_DETAIL_FRAME_POOL
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Thread-local cache recycling coroutine frames by size class
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * Frames are rounded up to a multiple of `granularity` and released
+ * frames are kept on a per-thread free list for their size class. An
+ * allocation is served from the free list of the current thread if
+ * possible (a hit) and from the global heap otherwise (a miss). Frames
+ * bigger than the largest size class always use the global heap. A
+ * frame may be released on a different thread than the one it was
+ * allocated on: it is cached by the releasing thread. At most
+ * `max_cached` frames are kept per size class and thread; the cached
+ * frames are returned to the global heap when the thread exits.
+ */
+class frame_pool {
+  public:
+    static constexpr std::size_t granularity{64u};
+    static constexpr std::size_t classes{16u};
+    static constexpr std::size_t max_cached{64u};
+    static constexpr std::size_t max_size{granularity * classes};
+
+    /*!
+     * \brief Counters of the calling thread's cache
+     */
+    struct stats {
+        std::size_t hits{};     //!< allocations served from the cache
+        std::size_t misses{};   //!< allocations served from the global heap
+        std::size_t recycled{}; //!< deallocations kept in the cache
+        std::size_t released{}; //!< deallocations returned to the global heap
+    };
+
+    static auto allocate(std::size_t size) -> void* {
+        if (max_size < size) {
+            ++local().counters.misses;
+            return ::operator new(size);
+        }
+        cache&  c{local()};
+        bucket& b{c.buckets[frame_pool::index(size)]};
+        if (b.head) {
+            ++c.counters.hits;
+            --b.count;
+            block* rc{b.head};
+            b.head = rc->next;
+            return rc;
+        }
+        ++c.counters.misses;
+        return ::operator new(frame_pool::rounded(size));
+    }
+    static auto deallocate(void* ptr, std::size_t size) noexcept -> void {
+        cache& c{local()};
+        if (max_size < size) {
+            ++c.counters.released;
+            ::operator delete(ptr, size);
+            return;
+        }
+        bucket& b{c.buckets[frame_pool::index(size)]};
+        if (c.closed || max_cached <= b.count) {
+            ++c.counters.released;
+            ::operator delete(ptr, frame_pool::rounded(size));
+            return;
+        }
+        if (not c.registered) {
+            frame_pool::register_cleanup(c);
+        }
+        ++c.counters.recycled;
+        ++b.count;
+        b.head = ::new (ptr) block{b.head};
+    }
+
+    static auto get_stats() noexcept -> stats { return local().counters; }
+    static auto reset_stats() noexcept -> void { local().counters = stats{}; }
+    /*!
+     * \brief Return all frames cached by the calling thread to the global heap
+     */
+    static auto trim() noexcept -> void {
+        cache& c{local()};
+        for (std::size_t i{}; i != classes; ++i) {
+            bucket& b{c.buckets[i]};
+            while (b.head) {
+                block* next{b.head->next};
+                ::operator delete(b.head, (i + 1u) * granularity);
+                b.head = next;
+            }
+            b.count = 0u;
+        }
+    }
+
+  private:
+    struct block {
+        block* next;
+    };
+    struct bucket {
+        block*      head{};
+        std::size_t count{};
+    };
+    // The cache is trivially destructible so it stays usable while other
+    // thread_local objects are destroyed; cleanup is done by a separate guard.
+    struct cache {
+        std::array<bucket, classes> buckets{};
+        stats                       counters{};
+        bool                        registered{};
+        bool                        closed{};
+    };
+    static_assert(::std::is_trivially_destructible_v<cache>);
+    struct cleanup {
+        cache* c;
+        ~cleanup() {
+            frame_pool::trim();
+            this->c->closed = true;
+        }
+    };
+
+    static constexpr auto index(std::size_t size) noexcept -> std::size_t {
+        return size == 0u ? 0u : (size - 1u) / granularity;
+    }
+    static constexpr auto rounded(std::size_t size) noexcept -> std::size_t {
+        return (frame_pool::index(size) + 1u) * granularity;
+    }
+    static auto local() noexcept -> cache& {
+        thread_local cache c{};
+        return c;
+    }
+    static auto register_cleanup(cache& c) noexcept -> void {
+        thread_local cleanup guard{&c};
+        c.registered = true;
+    }
+};
+
+/*!
+ * \brief Allocator using the thread-local frame_pool
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * Using this allocator as `allocator_type` of a task's environment causes
+ * the coroutine frames to be recycled via `frame_pool`. The allocator is
+ * stateless, i.e., it isn't stored in the coroutine frame.
+ */
+template <typename T = ::std::byte>
+struct frame_pool_allocator {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "frame_pool_allocator doesn't support over-aligned types");
+    using value_type      = T;
+    using is_always_equal = ::std::true_type;
+
+    frame_pool_allocator() = default;
+    template <typename U>
+    constexpr frame_pool_allocator(const frame_pool_allocator<U>&) noexcept {}
+
+    auto allocate(::std::size_t n) -> T* {
+        return static_cast<T*>(::beman::task::detail::frame_pool::allocate(n * sizeof(T)));
+    }
+    auto deallocate(T* ptr, ::std::size_t n) noexcept -> void {
+        ::beman::task::detail::frame_pool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    constexpr auto operator==(const frame_pool_allocator<U>&) const noexcept -> bool {
+        return true;
+    }
+};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
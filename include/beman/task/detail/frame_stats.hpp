@@ -0,0 +1,183 @@
+// include/beman/task/detail/frame_stats.hpp                          -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_BEMAN_TASK_DETAIL_FRAME_STATS
+#define INCLUDED_BEMAN_TASK_DETAIL_FRAME_STATS
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Process-wide statistics about coroutine frame allocations
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * When `BEMAN_TASK_FRAME_STATS` is defined (consistently for all
+ * translation units) the frames allocated via `allocator_support` are
+ * recorded per owning type (the promise type for tasks) and frame size.
+ * As the frame size depends on the parameters and locals of a coroutine,
+ * coroutines with different frame sizes get separate entries which
+ * typically identifies the coroutine. For each entry the number of
+ * allocations, the number of currently live frames, and the peak number
+ * of live frames are maintained. Recording uses a mutex and is intended
+ * for diagnostics, not production builds. Without the macro nothing is
+ * recorded and the statistics stay empty.
+ *
+ * The owner's name is taken from `std::source_location::function_name()`.
+ * On compilers whose function names don't include template arguments
+ * (notably MSVC) all owners share one name, i.e., the entries are only
+ * distinguished by frame size.
+ */
+class frame_stats {
+  public:
+#if defined(BEMAN_TASK_FRAME_STATS)
+    static constexpr bool enabled{true};
+#else
+    static constexpr bool enabled{false};
+#endif
+
+    /*!
+     * \brief Counters for frames of one size allocated for one owner type
+     */
+    struct entry {
+        std::string_view owner;         //!< name of the owning type
+        std::size_t      size{};        //!< frame size in bytes
+        std::size_t      allocations{}; //!< number of frames allocated
+        std::size_t      live{};        //!< number of frames currently allocated
+        std::size_t      peak_live{};   //!< maximum number of simultaneously live frames
+    };
+    /*!
+     * \brief Counters over all frames
+     */
+    struct totals {
+        std::size_t allocations{}; //!< number of frames allocated
+        std::size_t bytes{};       //!< number of bytes allocated for frames
+        std::size_t live{};        //!< number of frames currently allocated
+        std::size_t live_bytes{};  //!< number of bytes currently allocated for frames
+        std::size_t peak_live{};   //!< maximum number of simultaneously live frames
+    };
+
+    template <typename Owner>
+    static auto allocated(std::size_t size) -> void {
+        frame_stats::record(frame_stats::name<Owner>(), size);
+    }
+    template <typename Owner>
+    static auto deallocated(std::size_t size) noexcept -> void {
+        frame_stats::release(frame_stats::name<Owner>(), size);
+    }
+
+    /*!
+     * \brief Get the entries ordered by decreasing frame size
+     */
+    static auto get_stats() -> std::vector<entry> {
+        data&              d{frame_stats::get()};
+        std::lock_guard    cerberus(d.lock);
+        std::vector<entry> rc;
+        rc.reserve(d.entries.size());
+        for (const auto& [key, value] : d.entries)
+            rc.push_back(entry{key.first, key.second, value.allocations, value.live, value.peak_live});
+        std::sort(rc.begin(), rc.end(), [](const entry& a, const entry& b) { return b.size < a.size; });
+        return rc;
+    }
+    static auto get_totals() -> totals {
+        data&           d{frame_stats::get()};
+        std::lock_guard cerberus(d.lock);
+        return d.sum;
+    }
+    /*!
+     * \brief Forget all recorded entries and counters (live frames are kept)
+     */
+    static auto reset_stats() -> void {
+        data&           d{frame_stats::get()};
+        std::lock_guard cerberus(d.lock);
+        std::erase_if(d.entries, [](const auto& e) { return e.second.live == 0u; });
+        for (auto& [key, value] : d.entries)
+            value = counters{0u, value.live, value.live};
+        d.sum = totals{0u, 0u, d.sum.live, d.sum.live_bytes, d.sum.live};
+    }
+    /*!
+     * \brief Write the entries and a histogram of frame sizes to `out`
+     *
+     * The histogram uses power of two size buckets and shows the number of
+     * allocations per bucket.
+     */
+    static auto dump(std::ostream& out) -> void {
+        const std::vector<entry> entries{frame_stats::get_stats()};
+        const totals             sum{frame_stats::get_totals()};
+        out << "frames: allocations=" << sum.allocations << " bytes=" << sum.bytes << " live=" << sum.live
+            << " peak_live=" << sum.peak_live << "\n";
+        for (const entry& e : entries)
+            out << "  size=" << e.size << " allocations=" << e.allocations << " live=" << e.live
+                << " peak_live=" << e.peak_live << " owner=" << e.owner << "\n";
+
+        std::map<std::size_t, std::size_t> buckets;
+        std::size_t                        most{};
+        for (const entry& e : entries) {
+            std::size_t bucket{1u};
+            while (bucket < e.size)
+                bucket *= 2u;
+            most = std::max(most, buckets[bucket] += e.allocations);
+        }
+        for (const auto& [bucket, count] : buckets)
+            out << "  <=" << bucket << "\t" << count << "\t"
+                << std::string(most == 0u ? 0u : (count * 50u + most - 1u) / most, '#') << "\n";
+    }
+
+  private:
+    struct counters {
+        std::size_t allocations{};
+        std::size_t live{};
+        std::size_t peak_live{};
+    };
+    struct data {
+        std::mutex                                                   lock;
+        std::map<std::pair<std::string_view, std::size_t>, counters> entries;
+        totals                                                       sum;
+    };
+
+    template <typename Owner>
+    static auto name() noexcept -> std::string_view {
+        return std::source_location::current().function_name();
+    }
+    static auto get() -> data& {
+        static data d;
+        return d;
+    }
+    static auto record(std::string_view owner, std::size_t size) -> void {
+        data&           d{frame_stats::get()};
+        std::lock_guard cerberus(d.lock);
+        counters&       c{d.entries[{owner, size}]};
+        ++c.allocations;
+        c.peak_live = std::max(c.peak_live, ++c.live);
+        ++d.sum.allocations;
+        d.sum.bytes += size;
+        d.sum.live_bytes += size;
+        d.sum.peak_live = std::max(d.sum.peak_live, ++d.sum.live);
+    }
+    static auto release(std::string_view owner, std::size_t size) noexcept -> void {
+        data&           d{frame_stats::get()};
+        std::lock_guard cerberus(d.lock);
+        auto            it{d.entries.find({owner, size})};
+        if (it != d.entries.end() && 0u < it->second.live)
+            --it->second.live;
+        if (0u < d.sum.live) {
+            --d.sum.live;
+            d.sum.live_bytes -= std::min(d.sum.live_bytes, size);
+        }
+    }
+};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
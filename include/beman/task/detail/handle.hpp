@@ -5,6 +5,7 @@
 #define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_HANDLE
 
 #include <beman/execution/execution.hpp>
+#include <beman/task/detail/trace.hpp>
 #include <coroutine>
 #include <memory>
 #include <utility>
@@ -18,6 +19,7 @@ class handle {
     struct deleter {
         auto operator()(P* p) noexcept -> void {
             if (p) {
+                ::beman::task::detail::trace::emit(::beman::task::detail::trace_event::destroy, p);
                 std::coroutine_handle<P>::from_promise(*p).destroy();
             }
         }
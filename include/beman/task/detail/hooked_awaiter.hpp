@@ -0,0 +1,55 @@
+// include/beman/task/detail/hooked_awaiter.hpp                       -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_HOOKED_AWAITER
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_HOOKED_AWAITER
+
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Awaiter wrapper notifying the awaiting promise about suspension and resumption
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * The wrapped awaiter is created in place from the result of `make()` as
+ * awaiters of senders are generally not movable. Before the awaiter
+ * suspends `promise->on_suspend()` is called and before the result is
+ * obtained `promise->on_resume(suspended)` is called. The argument
+ * indicates whether the coroutine was actually suspended: even without
+ * suspension other coroutines may have run from `await_ready()`.
+ */
+template <typename Awaiter, typename Promise>
+class hooked_awaiter {
+  public:
+    template <typename Make>
+    hooked_awaiter(Promise* p, Make&& make) : awaiter(::std::forward<Make>(make)()), promise(p) {}
+
+    auto await_ready() -> bool { return this->awaiter.await_ready(); }
+    template <typename P>
+    auto await_suspend(::std::coroutine_handle<P> handle) {
+        this->promise->on_suspend();
+        this->suspended = true;
+        return this->awaiter.await_suspend(handle);
+    }
+    auto await_resume() -> decltype(auto) {
+        this->promise->on_resume(this->suspended);
+        return this->awaiter.await_resume();
+    }
+
+  private:
+    Awaiter  awaiter;
+    Promise* promise;
+    bool     suspended{};
+};
+template <typename Promise, typename Make>
+hooked_awaiter(Promise*, Make&&) -> hooked_awaiter<::std::invoke_result_t<Make>, Promise>;
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
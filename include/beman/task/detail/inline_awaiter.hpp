@@ -0,0 +1,161 @@
+// include/beman/task/detail/inline_awaiter.hpp                       -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_INLINE_AWAITER
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_INLINE_AWAITER
+
+#include <beman/execution/execution.hpp>
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+namespace inline_awaiter_detail {
+template <typename...>
+struct type_list {};
+
+template <typename>
+struct single_value;
+template <>
+struct single_value<type_list<>> {
+    using type = ::std::tuple<>;
+};
+template <typename... T>
+struct single_value<type_list<type_list<T...>>> {
+    using type = ::std::tuple<::std::decay_t<T>...>;
+};
+
+template <typename>
+struct resume_type;
+template <>
+struct resume_type<::std::tuple<>> {
+    using type = void;
+};
+template <typename T>
+struct resume_type<::std::tuple<T>> {
+    using type = T;
+};
+template <typename T0, typename T1, typename... T>
+struct resume_type<::std::tuple<T0, T1, T...>> {
+    using type = ::std::tuple<T0, T1, T...>;
+};
+
+template <typename Sender, typename Env>
+using value_t = typename single_value<
+    ::beman::execution::value_types_of_t<Sender, ::std::remove_cvref_t<Env>, type_list, type_list>>::type;
+
+template <typename Sender, typename Tag>
+concept sender_for = ::std::same_as<::beman::execution::tag_of_t<::std::remove_cvref_t<Sender>>,
+                                    ::std::remove_cvref_t<Tag>>;
+} // namespace inline_awaiter_detail
+
+/*!
+ * \brief Concept for senders which are known to complete before `start()` returns
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * These are exactly the `just`, `just_error`, `just_stopped`, and
+ * `read_env` senders: they complete every channel from `start()`. A value
+ * completion scheduler being the `inline_scheduler` doesn't say anything
+ * about the other channels and adaptors like `just() | then()` can't be
+ * recognized without decomposing the sender, i.e., these senders are still
+ * awaited through `affine`. Only senders with at most one value completion
+ * (as needed to produce the result of `co_await`) are considered.
+ */
+template <typename Sender, typename Env>
+concept inline_sender =
+    (inline_awaiter_detail::sender_for<Sender, decltype(::beman::execution::just)> ||
+     inline_awaiter_detail::sender_for<Sender, decltype(::beman::execution::just_error)> ||
+     inline_awaiter_detail::sender_for<Sender, decltype(::beman::execution::just_stopped)> ||
+     inline_awaiter_detail::sender_for<Sender, decltype(::beman::execution::read_env)>) &&
+    requires { typename inline_awaiter_detail::value_t<Sender, Env>; };
+
+/*!
+ * \brief Awaiter for an `inline_sender` which doesn't suspend the awaiting coroutine
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * The sender is connected to a receiver storing the result in the awaiter
+ * and started from `await_ready()`. As the sender completes inline,
+ * `await_ready()` returns `true` and the coroutine continues without
+ * suspending and without being rescheduled. Only a stopped completion
+ * suspends to let the promise's `unhandled_stopped()` take over. Errors
+ * are rethrown from `await_resume()` like `as_awaitable()` does.
+ */
+template <typename Sender, typename Promise>
+class inline_awaiter {
+  private:
+    using env_t    = decltype(::beman::execution::get_env(::std::declval<const Promise&>()));
+    using value_t  = inline_awaiter_detail::value_t<Sender, env_t>;
+    using resume_t = typename inline_awaiter_detail::resume_type<value_t>::type;
+    struct stopped_t {};
+    using result_t = ::std::variant<::std::monostate, value_t, ::std::exception_ptr, stopped_t>;
+
+    struct receiver {
+        using receiver_concept = ::beman::execution::receiver_tag;
+        inline_awaiter* aw;
+
+        template <typename... A>
+        auto set_value(A&&... a) && noexcept -> void {
+            try {
+                this->aw->result.template emplace<value_t>(::std::forward<A>(a)...);
+            } catch (...) {
+                this->aw->result.template emplace<::std::exception_ptr>(::std::current_exception());
+            }
+        }
+        template <typename E>
+        auto set_error(E&& error) && noexcept -> void {
+            if constexpr (::std::same_as<::std::remove_cvref_t<E>, ::std::exception_ptr>)
+                this->aw->result.template emplace<::std::exception_ptr>(::std::forward<E>(error));
+            else if constexpr (::std::same_as<::std::remove_cvref_t<E>, ::std::error_code>)
+                this->aw->result.template emplace<::std::exception_ptr>(
+                    ::std::make_exception_ptr(::std::system_error(error)));
+            else
+                this->aw->result.template emplace<::std::exception_ptr>(
+                    ::std::make_exception_ptr(::std::forward<E>(error)));
+        }
+        auto set_stopped() && noexcept -> void { this->aw->result.template emplace<stopped_t>(); }
+        auto get_env() const noexcept -> env_t { return ::beman::execution::get_env(*this->aw->promise); }
+    };
+    using state_t = decltype(::beman::execution::connect(::std::declval<Sender>(), ::std::declval<receiver>()));
+
+  public:
+    inline_awaiter(Sender&& sndr, Promise& p)
+        : promise(&p), state(::beman::execution::connect(::std::forward<Sender>(sndr), receiver{this})) {}
+    inline_awaiter(inline_awaiter&&) = delete;
+
+    auto await_ready() noexcept -> bool {
+        ::beman::execution::start(this->state);
+        assert(this->result.index() != 0u);
+        return not ::std::holds_alternative<stopped_t>(this->result);
+    }
+    auto await_suspend(::std::coroutine_handle<Promise> handle) noexcept -> ::std::coroutine_handle<> {
+        return handle.promise().unhandled_stopped();
+    }
+    auto await_resume() -> resume_t {
+        if (::std::exception_ptr* error = ::std::get_if<::std::exception_ptr>(&this->result))
+            ::std::rethrow_exception(::std::move(*error));
+        if constexpr (::std::tuple_size_v<value_t> == 1u)
+            return ::std::get<0>(::std::get<value_t>(::std::move(this->result)));
+        else if constexpr (not ::std::same_as<resume_t, void>)
+            return ::std::get<value_t>(::std::move(this->result));
+    }
+
+  private:
+    Promise* promise;
+    result_t result{};
+    state_t  state;
+};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,201 @@
+// include/beman/task/detail/mpsc_run_loop.hpp                        -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_MPSC_RUN_LOOP
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_MPSC_RUN_LOOP
+
+#include <beman/execution/execution.hpp>
+#include <beman/task/detail/can_run_inline.hpp>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Run loop with a lock-free queue for work submitted from many threads
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * The loop is an alternative to `run_loop` for a loop processed by one
+ * thread while work is scheduled from many threads. The operation states
+ * are linked into an intrusive list using a compare-and-swap, i.e.,
+ * scheduling doesn't lock a mutex. The thread running the loop takes all
+ * queued work at once and processes the batch in submission order. Only
+ * when no work is available after spinning briefly the thread is parked
+ * (using `std::atomic<T>::wait()` which is futex-based where available)
+ * and only then schedulers need to wake it.
+ *
+ * The scheduler completes with `set_value_t()` only and can, thus, be used
+ * with `task_scheduler`. While `run()` executes on a thread `can_run_inline`
+ * reports `true` for the loop's scheduler on that thread.
+ */
+class mpsc_run_loop {
+  private:
+    struct work {
+        work()                              = default;
+        work(work&&)                        = delete;
+        work(const work&)                   = delete;
+        work&        operator=(work&&)      = delete;
+        work&        operator=(const work&) = delete;
+        virtual void execute() noexcept     = 0;
+
+        work* next{};
+
+      protected:
+        ~work() = default;
+    };
+    struct finish_work final : work {
+        auto execute() noexcept -> void override {}
+    };
+
+    template <::beman::execution::receiver Receiver>
+    struct state final : work {
+        using operation_state_concept = ::beman::execution::operation_state_tag;
+        mpsc_run_loop* loop;
+        Receiver       receiver;
+
+        template <::beman::execution::receiver R>
+        state(mpsc_run_loop* l, R&& r) : loop(l), receiver(std::forward<R>(r)) {}
+        auto start() & noexcept -> void { this->loop->push(this); }
+        auto execute() noexcept -> void override { ::beman::execution::set_value(std::move(this->receiver)); }
+    };
+
+  public:
+    class scheduler;
+    class env {
+        friend class mpsc_run_loop;
+
+      private:
+        mpsc_run_loop* loop;
+        explicit env(mpsc_run_loop* l) noexcept : loop(l) {}
+
+      public:
+        auto query(const ::beman::execution::get_completion_scheduler_t<::beman::execution::set_value_t>&)
+            const noexcept -> scheduler;
+    };
+    class sender {
+        friend class scheduler;
+
+      private:
+        mpsc_run_loop* loop;
+        explicit sender(mpsc_run_loop* l) noexcept : loop(l) {}
+
+      public:
+        using sender_concept        = ::beman::execution::sender_tag;
+        using completion_signatures = ::beman::execution::completion_signatures<::beman::execution::set_value_t()>;
+        template <typename...>
+        static consteval auto get_completion_signatures() noexcept -> completion_signatures {
+            return {};
+        }
+
+        template <::beman::execution::receiver Receiver>
+        auto connect(Receiver&& receiver) const -> state<std::remove_cvref_t<Receiver>> {
+            return state<std::remove_cvref_t<Receiver>>(this->loop, std::forward<Receiver>(receiver));
+        }
+        auto get_env() const noexcept -> env { return env(this->loop); }
+    };
+    class scheduler {
+        friend class mpsc_run_loop;
+
+      private:
+        mpsc_run_loop* loop;
+        explicit scheduler(mpsc_run_loop* l) noexcept : loop(l) {}
+
+      public:
+        using scheduler_concept = ::beman::execution::scheduler_tag;
+
+        auto schedule() const noexcept -> sender { return sender(this->loop); }
+        auto query(const ::beman::task::detail::can_run_inline_t&) const noexcept -> bool {
+            return mpsc_run_loop::current() == this->loop;
+        }
+        auto operator==(const scheduler&) const noexcept -> bool = default;
+    };
+
+    static constexpr std::size_t spin_count{64u};
+
+    mpsc_run_loop() = default;
+    mpsc_run_loop(mpsc_run_loop&&) = delete;
+
+    auto get_scheduler() noexcept -> scheduler { return scheduler(this); }
+    /*!
+     * \brief Process work until `finish()` was called and no work is left
+     */
+    auto run() -> void {
+        mpsc_run_loop* previous{std::exchange(mpsc_run_loop::current(), this)};
+        for (;;) {
+            work* batch{this->head.exchange(nullptr, std::memory_order_acquire)};
+            if (batch == nullptr) {
+                if (this->finishing.load(std::memory_order_acquire) &&
+                    this->head.load(std::memory_order_acquire) == nullptr)
+                    break;
+                this->idle();
+                continue;
+            }
+            // The list is in LIFO order: reverse it to process the work in submission order.
+            work* fifo{};
+            while (batch) {
+                work* next{batch->next};
+                batch->next = fifo;
+                fifo        = batch;
+                batch       = next;
+            }
+            // Executing the work may destroy it: read the link first.
+            while (fifo) {
+                work* next{fifo->next};
+                fifo->execute();
+                fifo = next;
+            }
+        }
+        mpsc_run_loop::current() = previous;
+    }
+    /*!
+     * \brief Let `run()` return once there is no more work
+     */
+    auto finish() -> void {
+        if (not this->finishing.exchange(true, std::memory_order_acq_rel))
+            this->push(&this->finisher);
+    }
+
+  private:
+    static auto current() noexcept -> mpsc_run_loop*& {
+        static thread_local mpsc_run_loop* rc{};
+        return rc;
+    }
+
+    auto push(work* w) noexcept -> void {
+        work* h{this->head.load(std::memory_order_relaxed)};
+        do {
+            w->next = h;
+        } while (not this->head.compare_exchange_weak(h, w, std::memory_order_seq_cst, std::memory_order_relaxed));
+        // Only the first work added to an empty queue may need to wake the parked thread.
+        if (h == nullptr && this->sleeping.load(std::memory_order_seq_cst))
+            this->head.notify_one();
+    }
+    auto idle() noexcept -> void {
+        for (std::size_t i{}; i != spin_count; ++i)
+            if (this->head.load(std::memory_order_relaxed) != nullptr)
+                return;
+        this->sleeping.store(true, std::memory_order_seq_cst);
+        if (this->head.load(std::memory_order_seq_cst) == nullptr)
+            this->head.wait(nullptr, std::memory_order_acquire);
+        this->sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    std::atomic<work*> head{};
+    std::atomic<bool>  sleeping{};
+    std::atomic<bool>  finishing{};
+    finish_work        finisher{};
+};
+
+inline auto
+mpsc_run_loop::env::query(const ::beman::execution::get_completion_scheduler_t<::beman::execution::set_value_t>&)
+    const noexcept -> scheduler {
+    return scheduler(this->loop);
+}
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,48 @@
+// include/beman/task/detail/noexcept_environment.hpp                 -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_NOEXCEPT_ENVIRONMENT
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_NOEXCEPT_ENVIRONMENT
+
+#include <beman/execution/execution.hpp>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Environment for tasks without an error completion
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * A task using this environment doesn't have `set_error_t(std::exception_ptr)`
+ * (or any other error) in its completion signatures, i.e., receivers and
+ * algorithms like `sync_wait` or `when_all` don't need to provide storage
+ * for errors. An exception escaping from such a task calls `std::terminate()`.
+ * Custom environments get the same effect by defining `error_types` as
+ * `completion_signatures<>` and can use `unhandled_exception_hook` to
+ * handle escaping exceptions.
+ */
+struct noexcept_environment {
+    using error_types = ::beman::execution::completion_signatures<>;
+};
+
+/*!
+ * \brief Concept detecting an environment's hook for exceptions escaping a task
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * If the environment's `error_types` don't contain `std::exception_ptr` an
+ * exception escaping the task calls the `noexcept` static member function
+ * `Context::unhandled_exception()` if it exists. The hook is called while
+ * the exception is handled, i.e., it can use `throw;` to inspect it, e.g.,
+ * to log it. The task has no completion to report the exception: once the
+ * hook returns `std::terminate()` is called like it is without a hook.
+ */
+template <typename Context>
+concept unhandled_exception_hook = requires {
+    { Context::unhandled_exception() } noexcept;
+};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,579 @@
+// include/beman/task/detail/numa_context.hpp                         -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_NUMA_CONTEXT
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_NUMA_CONTEXT
+
+#include <beman/execution/execution.hpp>
+#include <beman/task/detail/can_run_inline.hpp>
+#include <beman/task/detail/thread_pool_context.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <filesystem>
+#include <fstream>
+#include <string>
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Context with a thread pool and a frame arena per NUMA node
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * For each NUMA node a `thread_pool_context` is created whose workers are
+ * pinned to the node's CPUs. The nodes are discovered from
+ * `/sys/devices/system/node` on Linux; if that isn't available (other
+ * systems, no NUMA support, restricted containers) a single node with all
+ * CPUs is used. The node layout can also be passed explicitly.
+ *
+ * Each node has an arena for coroutine frames used by
+ * `numa_frame_allocator`: a frame allocated on one of the node's threads
+ * is taken from the node's arena, i.e., it is either a frame released
+ * earlier to that node or it is newly allocated and first touched by the
+ * node's thread. Released frames return to the arena of the node they
+ * were allocated on, independent of the thread releasing them. Each of a
+ * node's threads caches frames it released and refills this cache from
+ * the node's arena in batches of `batch` frames, i.e., the arena's lock
+ * is only taken for batches and for frames released by other threads.
+ *
+ * The placement of the frames is best effort: new frames come from
+ * `operator new` and no memory policy (like `mbind()`) is applied. With
+ * the default first-touch policy a frame's pages are placed on the node
+ * of the thread touching them first. Pages which the heap already used
+ * before, possibly on another node, stay where they are.
+ *
+ * The schedulers of the nodes expose the allocator via `get_allocator`.
+ * Scheduling work for a node from a thread of another node, e.g., using
+ * `change_coroutine_scheduler` with a different node's scheduler, is
+ * counted as a migration in the nodes' `stats`.
+ *
+ * All tasks using the context's schedulers or allocator need to be
+ * completed before the context is destroyed.
+ */
+class numa_context {
+  private:
+    class node;
+
+  public:
+    static constexpr std::size_t granularity{64u};
+    static constexpr std::size_t classes{16u};
+    static constexpr std::size_t max_cached{1024u};
+    static constexpr std::size_t batch{32u};
+    static constexpr std::size_t max_size{granularity * classes};
+
+    /*!
+     * \brief Configuration of the nodes
+     *
+     * If `nodes` is empty the nodes are discovered. A `threads_per_node` of
+     * zero creates one worker per CPU of the node.
+     */
+    struct options {
+        std::vector<std::vector<std::size_t>> nodes{};
+        std::size_t                           threads_per_node{};
+        bool                                  pin{true};
+    };
+    /*!
+     * \brief Counters of one node
+     */
+    struct stats {
+        std::size_t allocations{};     //!< frames allocated from the node's arena
+        std::size_t reused{};          //!< allocations served by frames released earlier
+        std::size_t remote_releases{}; //!< frames released by threads not belonging to the node
+        std::size_t migrations_in{};   //!< work scheduled on the node from other nodes' threads
+        std::size_t migrations_out{};  //!< work scheduled by the node's threads on other nodes
+    };
+
+  private:
+    template <::beman::execution::receiver Receiver>
+    struct state {
+        struct forward {
+            using receiver_concept = ::beman::execution::receiver_tag;
+            state* self;
+            auto   set_value() && noexcept -> void {
+                numa_context::current() = this->self->target;
+                ::beman::execution::set_value(std::move(this->self->receiver));
+            }
+        };
+        using operation_state_concept = ::beman::execution::operation_state_tag;
+        using inner_t                 = decltype(::beman::execution::connect(
+            std::declval<::beman::task::detail::thread_pool_context::sender>(), std::declval<forward>()));
+
+        node*    target;
+        Receiver receiver;
+        inner_t  inner;
+
+        template <::beman::execution::receiver R>
+        state(node* n, R&& r)
+            : target(n),
+              receiver(std::forward<R>(r)),
+              inner(::beman::execution::connect(
+                  ::beman::execution::schedule(n->pool->get_scheduler()), forward{this})) {}
+        state(state&&) = delete;
+        auto start() & noexcept -> void {
+            node* from{numa_context::current()};
+            if (from != nullptr && from != this->target) {
+                from->migrations_out.fetch_add(1u, std::memory_order_relaxed);
+                this->target->migrations_in.fetch_add(1u, std::memory_order_relaxed);
+            }
+            ::beman::execution::start(this->inner);
+        }
+    };
+
+  public:
+    template <typename T>
+    struct allocator;
+    class scheduler;
+    class env {
+        friend class numa_context;
+
+      private:
+        node* target;
+        explicit env(node* n) noexcept : target(n) {}
+
+      public:
+        auto query(const ::beman::execution::get_completion_scheduler_t<::beman::execution::set_value_t>&)
+            const noexcept -> scheduler;
+        auto query(const ::beman::execution::get_allocator_t&) const noexcept -> allocator<std::byte>;
+    };
+    class sender {
+        friend class scheduler;
+
+      private:
+        node* target;
+        explicit sender(node* n) noexcept : target(n) {}
+
+      public:
+        using sender_concept        = ::beman::execution::sender_tag;
+        using completion_signatures = ::beman::execution::completion_signatures<::beman::execution::set_value_t()>;
+        template <typename...>
+        static consteval auto get_completion_signatures() noexcept -> completion_signatures {
+            return {};
+        }
+
+        template <::beman::execution::receiver Receiver>
+        auto connect(Receiver&& receiver) const -> state<std::remove_cvref_t<Receiver>> {
+            return state<std::remove_cvref_t<Receiver>>(this->target, std::forward<Receiver>(receiver));
+        }
+        auto get_env() const noexcept -> env { return env(this->target); }
+    };
+    class scheduler {
+        friend class numa_context;
+
+      private:
+        node* target;
+        explicit scheduler(node* n) noexcept : target(n) {}
+
+      public:
+        using scheduler_concept = ::beman::execution::scheduler_tag;
+
+        auto schedule() const noexcept -> sender { return sender(this->target); }
+        auto query(const ::beman::task::detail::can_run_inline_t&) const noexcept -> bool {
+            return numa_context::current() == this->target;
+        }
+        auto query(const ::beman::execution::get_allocator_t&) const noexcept -> allocator<std::byte>;
+        auto operator==(const scheduler&) const noexcept -> bool = default;
+    };
+
+    numa_context() : numa_context(options{}) {}
+    explicit numa_context(const options& opts) {
+        std::vector<std::vector<std::size_t>> layout{opts.nodes.empty() ? numa_context::discover() : opts.nodes};
+        this->nodes.reserve(layout.size());
+        for (std::size_t id{}; id != layout.size(); ++id) {
+            const std::size_t threads{opts.threads_per_node ? opts.threads_per_node
+                                                            : std::max(std::size_t(1u), layout[id].size())};
+            this->nodes.push_back(std::make_unique<node>(
+                id, ::beman::task::detail::thread_pool_context::options{threads, opts.pin, std::move(layout[id])}));
+        }
+    }
+    numa_context(numa_context&&) = delete;
+    ~numa_context() {
+        // All workers are stopped before any arena goes away: work on one node may release frames of another.
+        this->finish();
+        for (auto& n : this->nodes)
+            n->pool.reset();
+    }
+
+    auto size() const noexcept -> std::size_t { return this->nodes.size(); }
+    auto get_scheduler(std::size_t id = 0u) noexcept -> scheduler { return scheduler(this->nodes[id].get()); }
+    auto get_stats(std::size_t id) const -> stats { return this->nodes[id]->get_stats(); }
+    auto finish() -> void {
+        for (auto& n : this->nodes)
+            n->pool->finish();
+    }
+    /*!
+     * \brief Get the index of the node the calling thread belongs to, if any
+     */
+    static auto current_node() noexcept -> std::optional<std::size_t> {
+        const node* n{numa_context::current()};
+        return n ? std::optional<std::size_t>(n->id) : std::nullopt;
+    }
+
+    /*!
+     * \brief Allocate a frame from the arena of the calling thread's node (or the heap)
+     */
+    static auto allocate(std::size_t size) -> void* {
+        node*      n{numa_context::current()};
+        void*      memory{n ? n->allocate(header_size + size) : ::operator new(header_size + size)};
+        std::byte* raw{static_cast<std::byte*>(memory)};
+        ::new (raw) header{n};
+        return raw + header_size;
+    }
+    static auto deallocate(void* ptr, std::size_t size) noexcept -> void {
+        std::byte* raw{static_cast<std::byte*>(ptr) - header_size};
+        node*      n{std::launder(reinterpret_cast<header*>(raw))->owner};
+        if (n)
+            n->deallocate(raw, header_size + size, numa_context::current() != n);
+        else
+            ::operator delete(raw, header_size + size);
+    }
+
+    /*!
+     * \brief Find the CPUs of the NUMA nodes, degrading to one node with all CPUs
+     */
+    static auto discover() -> std::vector<std::vector<std::size_t>> {
+        std::vector<std::vector<std::size_t>> rc;
+#if defined(__linux__)
+        std::error_code                                               ec;
+        std::filesystem::directory_iterator                           it("/sys/devices/system/node", ec), end;
+        std::vector<std::pair<std::size_t, std::vector<std::size_t>>> found;
+        for (; not ec && it != end; it.increment(ec)) {
+            const std::string name{it->path().filename().string()};
+            std::size_t       id{};
+            if (not name.starts_with("node") ||
+                std::from_chars(name.data() + 4, name.data() + name.size(), id).ec != std::errc{})
+                continue;
+            std::ifstream            in(it->path() / "cpulist");
+            std::string              list;
+            std::vector<std::size_t> cpus;
+            if (std::getline(in, list))
+                cpus = numa_context::parse_cpulist(list);
+            if (not cpus.empty())
+                found.emplace_back(id, std::move(cpus));
+        }
+        std::ranges::sort(found);
+        for (auto& [id, cpus] : found)
+            rc.push_back(std::move(cpus));
+#endif
+        if (rc.empty()) {
+            rc.emplace_back();
+            for (std::size_t cpu{}; cpu != ::beman::task::detail::thread_pool_context::default_threads(); ++cpu)
+                rc.back().push_back(cpu);
+        }
+        return rc;
+    }
+    /*!
+     * \brief Parse a CPU list like `0-3,8,10-11`
+     */
+    static auto parse_cpulist(std::string_view list) -> std::vector<std::size_t> {
+        std::vector<std::size_t> rc;
+        const char*              it{list.data()};
+        const char* const        end{list.data() + list.size()};
+        while (it != end) {
+            std::size_t first{}, last{};
+            auto        r{std::from_chars(it, end, first)};
+            if (r.ec != std::errc{})
+                break;
+            last = first;
+            if (r.ptr != end && *r.ptr == '-') {
+                r = std::from_chars(r.ptr + 1, end, last);
+                if (r.ec != std::errc{})
+                    break;
+            }
+            for (std::size_t cpu{first}; cpu <= last; ++cpu)
+                rc.push_back(cpu);
+            it = r.ptr != end && *r.ptr == ',' ? r.ptr + 1 : end;
+        }
+        return rc;
+    }
+
+  private:
+    struct header {
+        node* owner;
+    };
+    static constexpr std::size_t header_size{__STDCPP_DEFAULT_NEW_ALIGNMENT__};
+    static_assert(sizeof(header) <= header_size);
+
+    struct block {
+        block* next;
+    };
+    struct bucket {
+        block*      head{};
+        std::size_t count{};
+    };
+    // Frames cached by one of a node's threads. Only the owning thread uses the buckets; the
+    // counters are atomic to allow get_stats() to read them. The cache is trivially destructible
+    // so it stays usable while other thread_local objects are destroyed.
+    struct cache {
+        node*                       owner{};
+        cache*                      next{};
+        std::array<bucket, classes> buckets{};
+        std::atomic<std::size_t>    allocations{};
+        std::atomic<std::size_t>    reused{};
+        bool                        closed{};
+    };
+    static_assert(::std::is_trivially_destructible_v<cache>);
+
+    class node {
+      public:
+        node(std::size_t i, const ::beman::task::detail::thread_pool_context::options& opts) : id(i) {
+            this->pool.emplace(opts);
+        }
+        node(node&&) = delete;
+        ~node() {
+            // The workers return their cached frames when they exit.
+            this->pool.reset();
+            for (std::size_t i{}; i != classes; ++i)
+                while (this->buckets[i]) {
+                    block* next{this->buckets[i]->next};
+                    ::operator delete(this->buckets[i], (i + 1u) * granularity);
+                    this->buckets[i] = next;
+                }
+        }
+
+        auto allocate(std::size_t size) -> void* {
+            cache* c{numa_context::local(this)};
+            if (c == nullptr)
+                return this->allocate_shared(size);
+            numa_context::bump(c->allocations);
+            if (max_size < size)
+                return ::operator new(size);
+            const std::size_t index{node::index(size)};
+            bucket&           b{c->buckets[index]};
+            if (b.head == nullptr)
+                this->refill(index, b);
+            if (block* rc{b.head}) {
+                numa_context::bump(c->reused);
+                --b.count;
+                b.head = rc->next;
+                return rc;
+            }
+            return ::operator new((index + 1u) * granularity);
+        }
+        auto deallocate(void* ptr, std::size_t size, bool remote) noexcept -> void {
+            if (remote)
+                return this->deallocate_shared(ptr, size, true);
+            if (max_size < size)
+                return ::operator delete(ptr, size);
+            cache* c{numa_context::local(this)};
+            if (c == nullptr)
+                return this->deallocate_shared(ptr, size, false);
+            const std::size_t index{node::index(size)};
+            bucket&           b{c->buckets[index]};
+            ++b.count;
+            b.head = ::new (ptr) block{b.head};
+            if (2u * batch < b.count)
+                this->flush(index, b, batch);
+        }
+        auto get_stats() const -> stats {
+            std::lock_guard cerberus(this->mutex);
+            stats           rc{this->counters};
+            for (const cache* c{this->caches}; c; c = c->next) {
+                rc.allocations += c->allocations.load(std::memory_order_relaxed);
+                rc.reused += c->reused.load(std::memory_order_relaxed);
+            }
+            rc.migrations_in  = this->migrations_in.load(std::memory_order_relaxed);
+            rc.migrations_out = this->migrations_out.load(std::memory_order_relaxed);
+            return rc;
+        }
+        auto attach(cache& c) noexcept -> void {
+            std::lock_guard cerberus(this->mutex);
+            c.owner      = this;
+            c.next       = this->caches;
+            this->caches = &c;
+        }
+        auto detach(cache& c) noexcept -> void {
+            for (std::size_t i{}; i != classes; ++i)
+                this->flush(i, c.buckets[i], c.buckets[i].count);
+            std::lock_guard cerberus(this->mutex);
+            this->counters.allocations += c.allocations.load(std::memory_order_relaxed);
+            this->counters.reused += c.reused.load(std::memory_order_relaxed);
+            cache** it{&this->caches};
+            while (*it != &c)
+                it = &(*it)->next;
+            *it = c.next;
+        }
+
+        const std::size_t        id;
+        std::atomic<std::size_t> migrations_in{};
+        std::atomic<std::size_t> migrations_out{};
+        // The pool is declared last: its workers are joined before the arena goes away.
+        std::optional<::beman::task::detail::thread_pool_context> pool;
+
+      private:
+        static constexpr auto index(std::size_t size) noexcept -> std::size_t {
+            return size == 0u ? 0u : (size - 1u) / granularity;
+        }
+
+        // Used by threads not belonging to the node and for frames released remotely.
+        auto allocate_shared(std::size_t size) -> void* {
+            {
+                std::lock_guard cerberus(this->mutex);
+                ++this->counters.allocations;
+                if (size <= max_size) {
+                    const std::size_t index{node::index(size)};
+                    if (block* b{this->buckets[index]}) {
+                        ++this->counters.reused;
+                        --this->count[index];
+                        this->buckets[index] = b->next;
+                        return b;
+                    }
+                    size = (index + 1u) * granularity;
+                }
+            }
+            return ::operator new(size);
+        }
+        auto deallocate_shared(void* ptr, std::size_t size, bool remote) noexcept -> void {
+            {
+                std::lock_guard cerberus(this->mutex);
+                this->counters.remote_releases += remote ? 1u : 0u;
+                if (size <= max_size) {
+                    const std::size_t index{node::index(size)};
+                    if (this->count[index] < max_cached) {
+                        ++this->count[index];
+                        this->buckets[index] = ::new (ptr) block{this->buckets[index]};
+                        return;
+                    }
+                    size = (index + 1u) * granularity;
+                }
+            }
+            ::operator delete(ptr, size);
+        }
+        // Move up to batch frames from the node's arena to a thread's cache.
+        auto refill(std::size_t index, bucket& b) noexcept -> void {
+            std::lock_guard cerberus(this->mutex);
+            for (std::size_t i{}; i != batch && this->buckets[index]; ++i) {
+                block* next{this->buckets[index]->next};
+                this->buckets[index]->next = b.head;
+                b.head                     = this->buckets[index];
+                this->buckets[index]       = next;
+                --this->count[index];
+                ++b.count;
+            }
+        }
+        // Move n frames from a thread's cache to the node's arena, releasing those exceeding max_cached.
+        auto flush(std::size_t index, bucket& b, std::size_t n) noexcept -> void {
+            block* excess{};
+            {
+                std::lock_guard cerberus(this->mutex);
+                for (; n != 0u && b.head; --n) {
+                    block* next{b.head->next};
+                    --b.count;
+                    if (this->count[index] < max_cached) {
+                        ++this->count[index];
+                        b.head->next         = this->buckets[index];
+                        this->buckets[index] = b.head;
+                    } else {
+                        b.head->next = excess;
+                        excess       = b.head;
+                    }
+                    b.head = next;
+                }
+            }
+            while (excess) {
+                block* next{excess->next};
+                ::operator delete(excess, (index + 1u) * granularity);
+                excess = next;
+            }
+        }
+
+        mutable std::mutex               mutex;
+        std::array<block*, classes>      buckets{};
+        std::array<std::size_t, classes> count{};
+        stats                            counters{};
+        cache*                           caches{};
+    };
+
+    struct cleanup {
+        cache* c;
+        ~cleanup() {
+            this->c->owner->detach(*this->c);
+            this->c->owner  = nullptr;
+            this->c->closed = true;
+        }
+    };
+
+    static auto bump(std::atomic<std::size_t>& counter) noexcept -> void {
+        // Only the owning thread modifies the counter: no read-modify-write is needed.
+        counter.store(counter.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+    }
+    static auto local(node* n) noexcept -> cache* {
+        thread_local cache c{};
+        if (c.owner == nullptr && not c.closed) {
+            n->attach(c);
+            thread_local cleanup guard{&c};
+        }
+        return c.owner == n ? &c : nullptr;
+    }
+    static auto current() noexcept -> node*& {
+        static thread_local node* rc{};
+        return rc;
+    }
+
+    std::vector<std::unique_ptr<node>> nodes;
+};
+
+/*!
+ * \brief Allocator using the frame arena of the calling thread's NUMA node
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * Using this allocator as `allocator_type` of a task's environment causes
+ * frames of tasks created on a thread of a `numa_context` to be allocated
+ * from that node's arena; on other threads the global heap is used. The
+ * allocator is stateless: the owning node is recorded in front of each
+ * allocation.
+ */
+template <typename T>
+struct numa_context::allocator {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "numa_frame_allocator doesn't support over-aligned types");
+    using value_type      = T;
+    using is_always_equal = ::std::true_type;
+
+    allocator() = default;
+    template <typename U>
+    constexpr allocator(const allocator<U>&) noexcept {}
+
+    auto allocate(::std::size_t n) -> T* { return static_cast<T*>(numa_context::allocate(n * sizeof(T))); }
+    auto deallocate(T* ptr, ::std::size_t n) noexcept -> void { numa_context::deallocate(ptr, n * sizeof(T)); }
+
+    template <typename U>
+    constexpr auto operator==(const allocator<U>&) const noexcept -> bool {
+        return true;
+    }
+};
+
+template <typename T = ::std::byte>
+using numa_frame_allocator = numa_context::allocator<T>;
+
+inline auto
+numa_context::env::query(const ::beman::execution::get_completion_scheduler_t<::beman::execution::set_value_t>&)
+    const noexcept -> scheduler {
+    return scheduler(this->target);
+}
+inline auto numa_context::env::query(const ::beman::execution::get_allocator_t&) const noexcept
+    -> allocator<std::byte> {
+    return {};
+}
+inline auto numa_context::scheduler::query(const ::beman::execution::get_allocator_t&) const noexcept
+    -> allocator<std::byte> {
+    return {};
+}
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
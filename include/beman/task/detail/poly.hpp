@@ -6,19 +6,49 @@
 
 #include <array>
 #include <concepts>
+#include <memory>
 #include <new>
 #include <cstddef>
+#include <utility>
 
 // ----------------------------------------------------------------------------
 
 namespace beman::task::detail {
+/*!
+ * \brief Determine whether an object of type `T` is stored inline by a poly with a buffer of `Size` bytes.
+ * \internal
+ */
+template <typename T, std::size_t Size>
+inline constexpr bool poly_fits_v{sizeof(T) <= Size && alignof(T) <= sizeof(double)};
+
+#if defined(BEMAN_TASK_POLY_REPORT_SPILLS)
+/*!
+ * \brief Diagnostic hook reporting types which don't fit into a poly buffer.
+ * \internal
+ *
+ * When `BEMAN_TASK_POLY_REPORT_SPILLS` is defined, every type stored out of
+ * line by a poly causes a deprecation warning whose instantiation context
+ * names the type, the buffer size, and the size of the type.
+ */
+template <typename T, std::size_t Size, std::size_t Required>
+[[deprecated("poly: type-erased object doesn't fit into the buffer and is allocated")]]
+constexpr void poly_spill_report() noexcept {}
+#endif
+
 /*!
  * \brief Utility providing small object optimization and type erasure.
  * \headerfile beman/task.hpp <beman/task.hpp>
  * \internal
+ *
+ * If `Allocator` is `void` objects need to fit into the buffer of `Size`
+ * bytes. Otherwise objects not fitting into the buffer are allocated
+ * using a rebound copy of the allocator.
  */
-template <typename Base, std::size_t Size = 4u * sizeof(void*)>
-class alignas(sizeof(double)) poly {
+template <typename Base, std::size_t Size = 4u * sizeof(void*), typename Allocator = void>
+class poly;
+
+template <typename Base, std::size_t Size>
+class alignas(sizeof(double)) poly<Base, Size, void> {
   private:
     std::array<std::byte, Size> buf{};
 
@@ -71,6 +101,174 @@ class alignas(sizeof(double)) poly {
     Base*       operator->() { return this->pointer(); }
     const Base* operator->() const { return this->pointer(); }
 };
+
+template <typename Base, std::size_t Size, typename Allocator>
+class alignas(sizeof(double)) poly {
+  public:
+    using allocator_type = typename ::std::allocator_traits<Allocator>::template rebind_alloc<::std::byte>;
+    template <typename T>
+    static constexpr bool fits{::beman::task::detail::poly_fits_v<T, Size>};
+
+  private:
+    struct spill_ops {
+        Base* (*clone)(const Base*, allocator_type&);
+        Base* (*move)(Base*, allocator_type&);
+        void (*destroy)(Base*, allocator_type&) noexcept;
+    };
+
+    std::array<std::byte, Size>          buf{};
+    [[no_unique_address]] allocator_type alloc;
+    Base*                                object{};
+    const spill_ops*                     ops{}; // non-null if the object is allocated
+    static constexpr bool has_move{requires(Base* b, void* t) { b->move(t); }};
+    static constexpr bool has_clone{requires(const Base* b, void* t) { b->clone(t); }};
+
+    Base* buffer() { return static_cast<Base*>(static_cast<void*>(buf.data())); }
+
+    template <typename T, typename... Args>
+    static Base* make(allocator_type& a, Args&&... args) {
+        using traits = typename ::std::allocator_traits<allocator_type>::template rebind_traits<T>;
+        typename traits::allocator_type talloc(a);
+        T*                              ptr{traits::allocate(talloc, 1u)};
+        try {
+            return ::new (static_cast<void*>(ptr)) T(::std::forward<Args>(args)...);
+        } catch (...) {
+            traits::deallocate(talloc, ptr, 1u);
+            throw;
+        }
+    }
+    template <typename T>
+    static auto get_ops() noexcept -> const spill_ops* {
+        static constexpr spill_ops rc{
+            [] {
+                if constexpr (::std::copy_constructible<T>)
+                    return +[](const Base* b, allocator_type& a) -> Base* {
+                        return poly::make<T>(a, static_cast<const T&>(*b));
+                    };
+                else
+                    return static_cast<Base* (*)(const Base*, allocator_type&)>(nullptr);
+            }(),
+            [] {
+                if constexpr (::std::move_constructible<T>)
+                    return +[](Base* b, allocator_type& a) -> Base* {
+                        return poly::make<T>(a, ::std::move(static_cast<T&>(*b)));
+                    };
+                else
+                    return static_cast<Base* (*)(Base*, allocator_type&)>(nullptr);
+            }(),
+            +[](Base* b, allocator_type& a) noexcept {
+                using traits = typename ::std::allocator_traits<allocator_type>::template rebind_traits<T>;
+                typename traits::allocator_type talloc(a);
+                T*                              ptr{static_cast<T*>(b)};
+                ptr->~T();
+                traits::deallocate(talloc, ptr, 1u);
+            }};
+        return &rc;
+    }
+
+    void reset() noexcept {
+        if (this->ops)
+            this->ops->destroy(this->object, this->alloc);
+        else if (this->object)
+            this->object->~Base();
+        this->object = nullptr;
+        this->ops    = nullptr;
+    }
+    // Move the object from other into this poly, leaving a moved-from object in other
+    void move_from(poly& other) {
+        if (other.ops) {
+            this->object = other.ops->move(other.object, this->alloc);
+            this->ops    = other.ops;
+        } else {
+            other.object->move(this->buf.data());
+            this->object = this->buffer();
+        }
+    }
+
+  public:
+    template <typename T, typename... Args>
+        requires ::std::default_initializable<allocator_type>
+    poly(T*, Args&&... args)
+        : poly(::std::allocator_arg, allocator_type(), static_cast<T*>(nullptr), ::std::forward<Args>(args)...) {}
+    template <typename T, typename... Args>
+    poly(::std::allocator_arg_t, const allocator_type& a, T*, Args&&... args) : alloc(a) {
+        if constexpr (fits<T>) {
+            this->object = ::new (this->buf.data()) T(::std::forward<Args>(args)...);
+        } else {
+#if defined(BEMAN_TASK_POLY_REPORT_SPILLS)
+            ::beman::task::detail::poly_spill_report<T, Size, sizeof(T)>();
+#endif
+            this->object = poly::make<T>(this->alloc, ::std::forward<Args>(args)...);
+            this->ops    = poly::get_ops<T>();
+        }
+    }
+    /*!
+     * \brief Move construct from `other`.
+     *
+     * An allocated object is moved into a new allocation, i.e., like an
+     * object in the buffer `other` keeps a valid moved-from object.
+     */
+    poly(poly&& other)
+        requires has_move
+        : alloc(other.alloc) {
+        this->move_from(other);
+    }
+    poly& operator=(poly&& other)
+        requires has_move
+    {
+        if (this != &other) {
+            this->reset();
+            this->move_from(other);
+        }
+        return *this;
+    }
+    poly& operator=(const poly& other)
+        requires has_clone
+    {
+        if (this != &other) {
+            this->reset();
+            if (other.ops) {
+                this->object = other.ops->clone(other.object, this->alloc);
+                this->ops    = other.ops;
+            } else {
+                other.object->clone(this->buf.data());
+                this->object = this->buffer();
+            }
+        }
+        return *this;
+    }
+    poly(const poly& other)
+        requires has_clone
+        : poly(::std::allocator_arg,
+               ::std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.alloc),
+               other) {}
+    poly(::std::allocator_arg_t, const allocator_type& a, const poly& other)
+        requires has_clone
+        : alloc(a) {
+        if (other.ops) {
+            this->object = other.ops->clone(other.object, this->alloc);
+            this->ops    = other.ops;
+        } else {
+            other.object->clone(this->buf.data());
+            this->object = this->buffer();
+        }
+    }
+    ~poly() { this->reset(); }
+    bool operator==(const poly& other) const
+        requires requires(const Base& b) {
+            { b.equals(&b) } -> std::same_as<bool>;
+        }
+    {
+        return other.object->equals(this->object);
+    }
+    /*!
+     * \brief Determine whether the object is allocated rather than stored in the buffer.
+     */
+    bool        allocated() const noexcept { return this->ops != nullptr; }
+    auto        get_allocator() const noexcept -> allocator_type { return this->alloc; }
+    Base*       operator->() { return this->object; }
+    const Base* operator->() const { return this->object; }
+};
 } // namespace beman::task::detail
 
 // ----------------------------------------------------------------------------
@@ -4,24 +4,31 @@
 #ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_PROMISE_TYPE
 #define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_PROMISE_TYPE
 
+#include <beman/task/detail/async_stack.hpp>
 #include <beman/task/detail/awaiter.hpp>
 #include <beman/task/detail/allocator_of.hpp>
 #include <beman/task/detail/allocator_support.hpp>
 #include <beman/task/detail/change_coroutine_scheduler.hpp>
+#include <beman/task/detail/current_allocator.hpp>
 #include <beman/task/detail/error_types_of.hpp>
 #include <beman/task/detail/final_awaiter.hpp>
 #include <beman/task/detail/find_allocator.hpp>
 #include <beman/task/detail/handle.hpp>
+#include <beman/task/detail/hooked_awaiter.hpp>
+#include <beman/task/detail/inline_awaiter.hpp>
+#include <beman/task/detail/noexcept_environment.hpp>
 #include <beman/task/detail/promise_base.hpp>
 #include <beman/task/detail/result_type.hpp>
 #include <beman/task/detail/scheduler_of.hpp>
 #include <beman/task/detail/state_base.hpp>
+#include <beman/task/detail/trace.hpp>
 #include <beman/task/detail/with_error.hpp>
 #include <beman/execution/execution.hpp>
 #include <beman/execution/detail/meta_contains.hpp>
 #include <beman/task/detail/promise_env.hpp>
 #include <coroutine>
 #include <optional>
+#include <source_location>
 #include <type_traits>
 
 // ----------------------------------------------------------------------------
@@ -42,14 +49,19 @@ template <typename Coroutine, typename Value, typename Environment>
 class promise_type
     : public ::beman::task::detail::
           promise_base<::beman::task::detail::stoppable::yes, ::std::remove_cvref_t<Value>, Environment>,
-      public ::beman::task::detail::allocator_support<::beman::task::detail::allocator_of_t<Environment>> {
+      public ::beman::task::detail::allocator_support<::beman::task::detail::allocator_of_t<Environment>,
+                                                      promise_type<Coroutine, Value, Environment>> {
   public:
     using allocator_type   = ::beman::task::detail::allocator_of_t<Environment>;
     using scheduler_type   = ::beman::task::detail::scheduler_of_t<Environment>;
     using stop_source_type = ::beman::task::detail::stop_source_of_t<Environment>;
     using stop_token_type  = decltype(std::declval<stop_source_type>().get_token());
 
-    constexpr auto initial_suspend() noexcept -> ::std::suspend_always { return {}; }
+    struct initial_awaiter : ::std::suspend_always {
+        promise_type* promise;
+        auto          await_resume() const noexcept -> void { this->promise->enter(); }
+    };
+    auto initial_suspend() noexcept -> initial_awaiter { return {{}, this}; }
     constexpr auto final_suspend() noexcept -> ::beman::task::detail::final_awaiter { return {}; }
 
     auto unhandled_exception() noexcept -> void {
@@ -57,27 +69,34 @@ class promise_type
         if constexpr (::beman::task::detail::meta::
                           list_contains_v<error_types, ::beman::execution::set_error_t(::std::exception_ptr)>) {
             this->get_state()->set_error(::std::current_exception());
+        } else if constexpr (::beman::task::detail::unhandled_exception_hook<Environment>) {
+            // The hook can observe the exception but there is no completion to report it.
+            Environment::unhandled_exception();
+            std::terminate();
         } else {
             std::terminate();
         }
     }
-    std::coroutine_handle<> unhandled_stopped() { return this->get_state()->complete(); }
+    std::coroutine_handle<> unhandled_stopped() {
+        // The task is suspended, i.e., it already restored the previous allocator.
+        ::beman::task::detail::trace::emit(::beman::task::detail::trace_event::complete, this);
+        return this->get_state()->complete();
+    }
 
-    auto get_return_object() noexcept { return Coroutine(::beman::task::detail::handle<promise_type>(this)); }
+    auto get_return_object() noexcept {
+        ::beman::task::detail::trace::emit(::beman::task::detail::trace_event::create, this);
+        return Coroutine(::beman::task::detail::handle<promise_type>(this));
+    }
 
     template <::beman::execution::sender Sender>
-    auto await_transform(Sender&& sender) {
-        if constexpr (requires {
-                          ::std::forward<Sender>(sender).as_awaitable(*this);
-                          // typename ::std::remove_cvref_t<Sender>::task_concept;
-                      }) {
-            return ::std::forward<Sender>(sender).as_awaitable(*this);
-        } else if constexpr (::std::same_as<::beman::execution::tag_of_t<::std::remove_cvref_t<Sender>>,
-                                            ::beman::execution::read_env_t>) {
-            return ::beman::execution::as_awaitable(::std::forward<Sender>(sender), *this);
-        } else {
-            return ::beman::execution::as_awaitable(::beman::execution::affine(::std::forward<Sender>(sender)), *this);
-        }
+    auto await_transform(Sender&& sender, const ::std::source_location& site = ::std::source_location::current()) {
+        this->stack_node.set_site(site);
+        if constexpr (::beman::task::detail::trace::enabled || ::beman::task::detail::async_stack::enabled ||
+                      not stateless_allocator)
+            return ::beman::task::detail::hooked_awaiter(
+                this, [this, &sender] { return this->make_awaitable(::std::forward<Sender>(sender)); });
+        else
+            return this->make_awaitable(::std::forward<Sender>(sender));
     }
     auto await_transform(::beman::task::detail::change_coroutine_scheduler<scheduler_type> c) {
         return ::std::move(c);
@@ -92,16 +111,47 @@ class promise_type
     auto get_env() const noexcept -> ::beman::task::detail::promise_env<promise_type> { return {this}; }
 
     auto start(::beman::task::detail::state_base<Value, Environment>* state) -> ::std::coroutine_handle<> {
+        ::beman::task::detail::trace::emit(::beman::task::detail::trace_event::start, this);
         this->set_state(state);
+        if constexpr (not stateless_allocator) {
+            // The handle's address is the pointer returned from allocator_support's operator new.
+            const allocator_type* frame{allocator_support_t::get_frame_allocator(
+                ::std::coroutine_handle<promise_type>::from_promise(*this).address())};
+            this->allocators.own = frame ? frame : state->get_allocator_ptr();
+        }
         return ::std::coroutine_handle<promise_type>::from_promise(*this);
     }
-    auto           notify_complete() -> ::std::coroutine_handle<> { return this->get_state()->complete(); }
+    auto notify_complete() -> ::std::coroutine_handle<> {
+        this->leave();
+        ::beman::task::detail::trace::emit(::beman::task::detail::trace_event::complete, this);
+        return this->get_state()->complete();
+    }
     scheduler_type change_scheduler(scheduler_type other) {
         return this->get_state()->set_start_scheduler(::std::move(other));
     }
 
     auto get_start_scheduler() const noexcept -> scheduler_type { return this->get_state()->get_start_scheduler(); }
-    auto get_allocator() const noexcept -> allocator_type { return this->get_state()->get_allocator(); }
+    auto get_allocator() const noexcept -> allocator_type {
+        if constexpr (not stateless_allocator) {
+            if (const allocator_type* alloc{this->get_allocator_ptr()})
+                return *alloc;
+        }
+        return this->get_state()->get_allocator();
+    }
+    /*!
+     * \brief Get the allocator made available to tasks created while this task runs
+     *
+     * This is the allocator embedded into the frame if the frame wasn't
+     * allocated using a default constructed allocator. Otherwise it is an
+     * allocator kept by the state or the parent, if any. It is determined
+     * when the task is started.
+     */
+    auto get_allocator_ptr() const noexcept -> const allocator_type* {
+        if constexpr (stateless_allocator)
+            return nullptr;
+        else
+            return this->allocators.own;
+    }
     auto get_stop_token() const noexcept -> stop_token_type { return this->get_state()->get_stop_token(); }
     auto get_environment() const noexcept -> const Environment& {
         assert(this);
@@ -109,10 +159,63 @@ class promise_type
         return this->get_state()->get_environment();
     }
 
+    auto get_async_stack_node() noexcept -> ::beman::task::detail::async_stack_node& { return this->stack_node; }
+    auto on_suspend() noexcept -> void {
+        ::beman::task::detail::trace::emit(::beman::task::detail::trace_event::suspend, this);
+        this->stack_node.set_suspended(true);
+        this->leave();
+    }
+    auto on_resume(bool suspended) noexcept -> void {
+        // Without suspension tasks run from await_ready() restored this task's allocator.
+        if (suspended) {
+            this->enter();
+            this->stack_node.set_suspended(false);
+            ::beman::task::detail::trace::emit(::beman::task::detail::trace_event::resume, this);
+        }
+    }
+
   private:
-    using env_t = ::beman::task::detail::promise_env<promise_type>;
+    using env_t               = ::beman::task::detail::promise_env<promise_type>;
+    using allocator_support_t = ::beman::task::detail::allocator_support<allocator_type, promise_type>;
+    static constexpr bool stateless_allocator{allocator_support_t::stateless};
+    struct no_allocator {};
+    struct allocator_ptrs {
+        const allocator_type* own{};      // made available while this task runs
+        const allocator_type* previous{}; // restored when this task suspends
+    };
+    using allocator_ptrs_t = ::std::conditional_t<stateless_allocator, no_allocator, allocator_ptrs>;
+
+    // Make the allocator available to tasks created while this task runs.
+    // The previous allocator is restored when the task suspends as the task
+    // may run nested, e.g., within a sync_wait() of another task.
+    auto enter() noexcept -> void {
+        if constexpr (not stateless_allocator) {
+            this->allocators.previous = ::beman::task::detail::current_allocator<allocator_type>::get();
+            ::beman::task::detail::current_allocator<allocator_type>::set(this->allocators.own);
+        }
+    }
+    auto leave() noexcept -> void {
+        if constexpr (not stateless_allocator)
+            ::beman::task::detail::current_allocator<allocator_type>::set(this->allocators.previous);
+    }
+
+    template <::beman::execution::sender Sender>
+    auto make_awaitable(Sender&& sender) {
+        if constexpr (requires {
+                          ::std::forward<Sender>(sender).as_awaitable(*this);
+                          // typename ::std::remove_cvref_t<Sender>::task_concept;
+                      }) {
+            return ::std::forward<Sender>(sender).as_awaitable(*this);
+        } else if constexpr (::beman::task::detail::inline_sender<Sender, env_t>) {
+            return ::beman::task::detail::inline_awaiter<Sender, promise_type>(::std::forward<Sender>(sender), *this);
+        } else {
+            return ::beman::execution::as_awaitable(::beman::execution::affine(::std::forward<Sender>(sender)), *this);
+        }
+    }
 
-    ::std::optional<scheduler_type> scheduler{};
+    ::std::optional<scheduler_type>                              scheduler{};
+    [[no_unique_address]] allocator_ptrs_t                        allocators{};
+    [[no_unique_address]] ::beman::task::detail::async_stack_node stack_node{this};
 };
 } // namespace beman::task::detail
 
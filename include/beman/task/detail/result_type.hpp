@@ -7,6 +7,9 @@
 #include <beman/task/detail/sub_visit.hpp>
 #include <beman/execution/execution.hpp>
 #include <exception>
+#include <expected>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <type_traits>
 #include <variant>
@@ -27,6 +30,128 @@ enum void_type : unsigned char {};
  */
 enum class stoppable { yes, no };
 
+/**
+ * \brief Concept for value types stored by the compact result storage
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ */
+template <typename Value>
+concept compact_result_value = ::std::same_as<void, Value> || ::std::is_trivially_copyable_v<Value>;
+
+/**
+ * \brief Compact result storage used for the common result types
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * For `void` or trivially copyable values combined with either no error or
+ * only `std::exception_ptr` as error the result is stored in a union
+ * accompanied by a tag byte. Compared to the `std::variant` used otherwise
+ * completing doesn't need any visitation and `result_resume()` checks for
+ * the value first. Derived classes can put small members into the tail
+ * padding following the tag.
+ */
+template <::beman::task::detail::stoppable Stop, typename Value, bool WithError>
+class compact_result {
+  private:
+    using value_type = ::std::conditional_t<::std::same_as<void, Value>, void_type, Value>;
+    enum class tag_t : unsigned char { none, value, error };
+    struct no_error {};
+    using error_type = ::std::conditional_t<WithError, ::std::exception_ptr, no_error>;
+
+    union storage {
+        storage() noexcept {}
+        ~storage() {}
+        value_type value;
+        error_type error;
+    };
+
+    storage result;
+    tag_t   tag{tag_t::none};
+
+    auto reset() noexcept -> void {
+        if constexpr (WithError)
+            if (this->tag == tag_t::error)
+                ::std::destroy_at(&this->result.error);
+        this->tag = tag_t::none;
+    }
+
+  public:
+    compact_result() = default;
+    ~compact_result() { this->reset(); }
+
+    /**
+     * \brief Set the result for a `set_value` completion.
+     */
+    template <typename T>
+    auto set_value(T&& value) -> void {
+        this->reset();
+        ::std::construct_at(&this->result.value, ::std::forward<T>(value));
+        this->tag = tag_t::value;
+    }
+    /**
+     * \brief Set the result for a `set_error` completion.
+     */
+    template <typename E>
+    auto set_error(E&& error) -> void
+        requires WithError
+    {
+        static_assert(::std::same_as<::std::remove_cvref_t<E>, ::std::exception_ptr>,
+                      "error type not found in result type");
+        this->reset();
+        ::std::construct_at(&this->result.error, ::std::forward<E>(error));
+        this->tag = tag_t::error;
+    }
+
+    auto no_completion_set() const noexcept -> bool { return this->tag == tag_t::none; }
+    /**
+     * \brief Call the completion function according to the current result.
+     */
+    template <::beman::execution::receiver Receiver>
+    auto result_complete(Receiver&& rcvr) -> void {
+        if (this->tag == tag_t::value) [[likely]] {
+            if constexpr (::std::same_as<::beman::task::detail::void_type, value_type>)
+                ::beman::execution::set_value(::std::move(rcvr));
+            else
+                ::beman::execution::set_value(::std::move(rcvr), ::std::move(this->result.value));
+        } else if (this->tag == tag_t::none) {
+            if constexpr (Stop == ::beman::task::detail::stoppable::yes)
+                ::beman::execution::set_stopped(::std::move(rcvr));
+            else
+                ::std::terminate();
+        } else if constexpr (WithError) {
+            ::beman::execution::set_error(::std::move(rcvr), ::std::move(this->result.error));
+        }
+    }
+    auto result_resume() {
+        if (this->tag != tag_t::value) [[unlikely]] {
+            if constexpr (WithError)
+                if (this->tag == tag_t::error)
+                    ::std::rethrow_exception(::std::move(this->result.error));
+            ::std::terminate(); // should never come here!
+        }
+        if constexpr (::std::same_as<::beman::task::detail::void_type, value_type>)
+            return;
+        else
+            return ::std::move(this->result.value);
+    }
+    /**
+     * \brief Produce the result as `Expected` without throwing an error.
+     */
+    template <typename Expected>
+    auto result_expected() -> Expected {
+        if (this->tag == tag_t::value) [[likely]] {
+            if constexpr (::std::same_as<::beman::task::detail::void_type, value_type>)
+                return Expected();
+            else
+                return Expected(::std::in_place, ::std::move(this->result.value));
+        }
+        if constexpr (WithError)
+            if (this->tag == tag_t::error)
+                return Expected(::std::unexpect, ::std::move(this->result.error));
+        ::std::terminate(); // should never come here!
+    }
+};
+
 /**
  * \brief Type to hold the result of a coroutine
  * \headerfile beman/task.hpp <beman/task.hpp>
@@ -132,6 +257,29 @@ class result_type<Stop, Value, ::beman::execution::completion_signatures<::beman
         else
             return ::std::move(::std::get<1u>(this->result));
     }
+    /**
+     * \brief Produce the result as `Expected` without throwing an error.
+     *
+     * An error is stored as the error of the returned object, i.e., neither
+     * an exception is thrown nor an `std::exception_ptr` is created.
+     */
+    template <typename Expected>
+    auto result_expected() -> Expected {
+        if (this->result.index() == 1u) {
+            if constexpr (::std::same_as<::beman::task::detail::void_type, value_type>)
+                return Expected();
+            else
+                return Expected(::std::in_place, ::std::move(::std::get<1u>(this->result)));
+        }
+        if constexpr (0u < sizeof...(Error)) {
+            ::std::optional<Expected> rc;
+            ::beman::task::detail::sub_visit<2u>(
+                [&rc](auto& error) { rc.emplace(::std::unexpect, ::std::move(error)); }, this->result);
+            if (rc)
+                return ::std::move(*rc);
+        }
+        ::std::terminate(); // should never come here!
+    }
 };
 template <::beman::task::detail::stoppable Stop, typename Value>
 class result_type<Stop, Value, ::beman::execution::completion_signatures<>> {
@@ -211,7 +359,27 @@ class result_type<Stop, Value, ::beman::execution::completion_signatures<>> {
         else
             return ::std::move(::std::get<1u>(this->result));
     }
+    /**
+     * \brief Produce the result as `Expected`.
+     */
+    template <typename Expected>
+    auto result_expected() -> Expected {
+        if (this->result.index() != 1u)
+            ::std::terminate(); // should never come here!
+        if constexpr (::std::same_as<::beman::task::detail::void_type, value_type>)
+            return Expected();
+        else
+            return Expected(::std::in_place, ::std::move(::std::get<1u>(this->result)));
+    }
 };
+template <::beman::task::detail::stoppable Stop, ::beman::task::detail::compact_result_value Value>
+class result_type<Stop,
+                  Value,
+                  ::beman::execution::completion_signatures<::beman::execution::set_error_t(::std::exception_ptr)>>
+    : public ::beman::task::detail::compact_result<Stop, Value, true> {};
+template <::beman::task::detail::stoppable Stop, ::beman::task::detail::compact_result_value Value>
+class result_type<Stop, Value, ::beman::execution::completion_signatures<>>
+    : public ::beman::task::detail::compact_result<Stop, Value, false> {};
 } // namespace beman::task::detail
 
 // ----------------------------------------------------------------------------
@@ -4,29 +4,49 @@
 #ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_SINGLE_THREAD_CONTEXT
 #define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_SINGLE_THREAD_CONTEXT
 
+#include <beman/task/detail/can_run_inline.hpp>
+#include <beman/task/detail/mpsc_run_loop.hpp>
 #include <beman/execution/execution.hpp>
+#include <concepts>
 #include <functional>
 #include <thread>
 
 // ----------------------------------------------------------------------------
 
 namespace beman::task::detail {
-class single_thread_context {
+/*!
+ * \brief Context processing work on one thread using a `Loop`
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * The `Loop` is either `run_loop` (the default) or `mpsc_run_loop` which
+ * is better suited for work scheduled from many threads.
+ */
+template <typename Loop = ::beman::execution::run_loop>
+class basic_single_thread_context {
   private:
-    ::beman::execution::run_loop loop;
-    ::std::thread                thread{&single_thread_context::run, this};
+    Loop          loop;
+    ::std::thread thread{&basic_single_thread_context::run, this};
 
-    static auto run(single_thread_context* self) -> void { self->loop.run(); }
+    static auto run(basic_single_thread_context* self) -> void {
+        if constexpr (::std::same_as<Loop, ::beman::execution::run_loop>) {
+            ::beman::task::detail::run_loop_scope scope(self->loop);
+            self->loop.run();
+        } else
+            self->loop.run();
+    }
 
   public:
-    single_thread_context() = default;
-    ~single_thread_context() {
+    basic_single_thread_context() = default;
+    ~basic_single_thread_context() {
         this->finish();
         this->thread.join();
     }
     auto get_scheduler() { return this->loop.get_scheduler(); }
     void finish() { this->loop.finish(); }
 };
+
+using single_thread_context      = ::beman::task::detail::basic_single_thread_context<>;
+using mpsc_single_thread_context = ::beman::task::detail::basic_single_thread_context<mpsc_run_loop>;
 } // namespace beman::task::detail
 // ----------------------------------------------------------------------------
 
@@ -7,6 +7,7 @@
 #include <beman/task/detail/promise_type.hpp>
 #include <beman/task/detail/state_base.hpp>
 #include <beman/task/detail/state_rep.hpp>
+#include <beman/task/detail/stop_forward.hpp>
 #include <beman/task/detail/stop_source.hpp>
 #include <type_traits>
 #include <utility>
@@ -14,7 +15,17 @@
 // ----------------------------------------------------------------------------
 
 namespace beman::task::detail {
-
+/*!
+ * \brief Operation state of a task connected to a receiver
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * If the receiver's stop token has the task's stop token type the token is
+ * obtained from the receiver's environment when requested and the state
+ * doesn't store a stop source. Otherwise a stop source connected to the
+ * receiver's stop token is only created when a stop token is requested
+ * and stopping is actually possible.
+ */
 template <typename Task, typename T, typename C, typename Receiver>
 struct state : ::beman::task::detail::state_base<T, C>, ::beman::task::detail::state_rep<C, Receiver> {
     using operation_state_concept = ::beman::execution::operation_state_tag;
@@ -23,52 +34,49 @@ struct state : ::beman::task::detail::state_base<T, C>, ::beman::task::detail::s
     using allocator_type          = typename ::beman::task::detail::state_base<T, C>::allocator_type;
     using stop_source_type        = ::beman::task::detail::stop_source_of_t<C>;
     using stop_token_type         = decltype(std::declval<stop_source_type>().get_token());
-    using stop_token_t =
-        decltype(::beman::execution::get_stop_token(::beman::execution::get_env(std::declval<Receiver>())));
-    struct stop_link {
-        stop_source_type& source;
-        void              operator()() const noexcept { source.request_stop(); }
-    };
-    using stop_callback_t = ::beman::execution::stop_callback_for_t<stop_token_t, stop_link>;
+    using stop_token_t            = ::std::remove_cvref_t<decltype(::beman::execution::get_stop_token(
+        ::beman::execution::get_env(std::declval<std::remove_cvref_t<Receiver>&>())))>;
+    using stop_forward_t          = ::beman::task::detail::stop_forward<stop_token_t, stop_source_type>;
     template <typename R, typename H>
     state(R&& r, H h) noexcept //-dk:TODO break down to various members
-        : state_rep<C, Receiver>(std::forward<R>(r)),
+        : ::beman::task::detail::state_base<T, C>(this),
+          state_rep<C, Receiver>(std::forward<R>(r)),
           handle(std::move(h)),
-          scheduler(this->template from_env<scheduler_type>(::beman::execution::get_env(this->receiver))) {}
+          scheduler(this->template from_env<scheduler_type>(::beman::execution::get_env(this->receiver))),
+          allocator(state::from_receiver(this->receiver)) {
+        this->bind(this->scheduler, this->context);
+    }
 
     ::beman::task::detail::handle<promise_type> handle;
-    stop_source_type                            source;
-    std::optional<stop_callback_t>              stop_callback;
+    [[no_unique_address]] stop_forward_t        stop;
     scheduler_type                              scheduler;
+    // The environment's allocator is kept to make it available to tasks created by the task.
+    [[no_unique_address]] allocator_type        allocator;
 
     auto                    start() & noexcept -> void { this->handle.start(this).resume(); }
-    std::coroutine_handle<> do_complete() override {
+    std::coroutine_handle<> do_complete() {
         this->handle.reset();
         this->result_complete(::std::move(this->receiver));
         return std::noop_coroutine();
     }
-    auto do_get_allocator() -> allocator_type override {
-        if constexpr (requires {
-                          allocator_type(
-                              ::beman::execution::get_allocator(::beman::execution::get_env(this->receiver)));
-                      })
-            return allocator_type(::beman::execution::get_allocator(::beman::execution::get_env(this->receiver)));
+    static constexpr bool has_env_allocator{requires(const ::std::remove_cvref_t<Receiver>& r) {
+        allocator_type(::beman::execution::get_allocator(::beman::execution::get_env(r)));
+    }};
+    static auto from_receiver([[maybe_unused]] const ::std::remove_cvref_t<Receiver>& r) -> allocator_type {
+        if constexpr (has_env_allocator)
+            return allocator_type(::beman::execution::get_allocator(::beman::execution::get_env(r)));
         else
             return allocator_type{};
     }
-    auto do_get_start_scheduler() -> scheduler_type override { return this->scheduler; }
-    auto do_set_start_scheduler(scheduler_type other) -> scheduler_type override {
-        return ::std::exchange(this->scheduler, other);
+    auto do_get_allocator() -> allocator_type { return this->allocator; }
+    auto do_get_allocator_ptr() const noexcept -> const allocator_type*
+        requires has_env_allocator
+    {
+        return &this->allocator;
     }
-    stop_token_type do_get_stop_token() override {
-        if (this->source.stop_possible() && not this->stop_callback) {
-            this->stop_callback.emplace(
-                ::beman::execution::get_stop_token(::beman::execution::get_env(this->receiver)),
-                stop_link{this->source});
-        }
-        return this->source.get_token();
+    stop_token_type do_get_stop_token() {
+        return this->stop.get_token(::beman::execution::get_stop_token(::beman::execution::get_env(this->receiver)));
     }
-    C& do_get_environment() override { return this->context; }
 };
 } // namespace beman::task::detail
 
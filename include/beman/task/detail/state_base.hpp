@@ -9,11 +9,26 @@
 #include <beman/task/detail/allocator_of.hpp>
 #include <beman/task/detail/error_types_of.hpp>
 #include <beman/task/detail/result_type.hpp>
+#include <cassert>
 #include <coroutine>
+#include <utility>
 
 // ----------------------------------------------------------------------------
 
 namespace beman::task::detail {
+/*!
+ * \brief Operation state interface used by a task's promise
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * The promise of a task either refers to a `state` (the task was `connect`ed
+ * to a receiver) or to an `awaiter` (the task is `co_await`ed by another
+ * task). The operations depending on the kind of state are dispatched
+ * through a static table of function pointers created for the derived type
+ * passed to the constructor. The start scheduler, the environment, and,
+ * where the derived type binds one, the stop token are referenced directly
+ * and accessing them doesn't involve an indirect call.
+ */
 template <typename Value, typename Environment>
 class state_base : public ::beman::task::detail::result_type<::beman::task::detail::stoppable::yes,
                                                              Value,
@@ -24,17 +39,55 @@ class state_base : public ::beman::task::detail::result_type<::beman::task::deta
     using stop_token_type  = decltype(std::declval<stop_source_type>().get_token());
     using scheduler_type   = ::beman::task::detail::scheduler_of_t<Environment>;
 
-    auto complete() -> std::coroutine_handle<> { return this->do_complete(); }
-    auto get_allocator() -> allocator_type { return this->do_get_allocator(); }
-    auto get_stop_token() -> stop_token_type { return this->do_get_stop_token(); }
+    auto complete() -> std::coroutine_handle<> { return this->vtbl->complete(*this); }
+    auto get_allocator() -> allocator_type { return this->vtbl->get_allocator(*this); }
+    /*!
+     * \brief Get a pointer to an allocator which stays valid while the task runs, if there is one
+     */
+    auto get_allocator_ptr() -> const allocator_type* {
+        return this->vtbl->get_allocator_ptr ? this->vtbl->get_allocator_ptr(*this) : nullptr;
+    }
+    auto get_stop_token() -> stop_token_type {
+        return this->token_ptr ? *this->token_ptr : this->vtbl->get_stop_token(*this);
+    }
     auto get_environment() -> Environment& {
-        assert(this);
-        return this->do_get_environment();
+        assert(this->env_ptr);
+        return *this->env_ptr;
+    }
+    auto get_start_scheduler() -> scheduler_type {
+        assert(this->sched_ptr);
+        return *this->sched_ptr;
     }
-    auto get_start_scheduler() -> scheduler_type { return this->do_get_start_scheduler(); }
-    auto set_start_scheduler(scheduler_type other) -> scheduler_type { return this->do_set_start_scheduler(other); }
+    auto set_start_scheduler(scheduler_type other) -> scheduler_type {
+        assert(this->sched_ptr);
+        this->sched_changed = true;
+        return ::std::exchange(*this->sched_ptr, ::std::move(other));
+    }
+    /*!
+     * \brief Determine whether `set_start_scheduler()` was ever used
+     */
+    auto start_scheduler_changed() const noexcept -> bool { return this->sched_changed; }
 
   protected:
+    /*!
+     * \brief Set up the dispatch table for `Derived`.
+     *
+     * `Derived` needs to provide `do_complete()` and `do_get_allocator()`.
+     * It may provide `do_get_allocator_ptr()` if it can refer to an
+     * allocator which stays valid while the task runs.
+     * If `Derived` doesn't provide `do_get_stop_token()` it needs to use
+     * `bind_stop_token()` before the stop token is requested.
+     */
+    template <typename Derived>
+    explicit state_base(Derived*) noexcept : vtbl(state_base::get_vtable<Derived>()) {}
+    ~state_base() = default;
+
+    auto bind(scheduler_type& sched, Environment& env) noexcept -> void {
+        this->sched_ptr = &sched;
+        this->env_ptr   = &env;
+    }
+    auto bind_stop_token(stop_token_type& token) noexcept -> void { this->token_ptr = &token; }
+
     template <::beman::execution::scheduler Scheduler, typename Env>
     static auto from_env(const Env& env) {
         if constexpr (requires { Scheduler(::beman::execution::get_start_scheduler(env)); }) {
@@ -46,16 +99,45 @@ class state_base : public ::beman::task::detail::result_type<::beman::task::deta
         }
     }
 
-    // NOLINTBEGIN(portability-template-virtual-member-function)
-    virtual auto do_complete() -> std::coroutine_handle<>                       = 0;
-    virtual auto do_get_allocator() -> allocator_type                           = 0;
-    virtual auto do_get_stop_token() -> stop_token_type                         = 0;
-    virtual auto do_get_environment() -> Environment&                           = 0;
-    virtual auto do_get_start_scheduler() -> scheduler_type                     = 0;
-    virtual auto do_set_start_scheduler(scheduler_type other) -> scheduler_type = 0;
-    // NOLINTEND(portability-template-virtual-member-function)
+  private:
+    struct vtable {
+        std::coroutine_handle<> (*complete)(state_base&);
+        allocator_type (*get_allocator)(state_base&);
+        const allocator_type* (*get_allocator_ptr)(state_base&);
+        stop_token_type (*get_stop_token)(state_base&);
+    };
+    template <typename Derived>
+    static auto get_vtable() noexcept -> const vtable* {
+        static constexpr vtable table{
+            +[](state_base& s) -> std::coroutine_handle<> { return static_cast<Derived&>(s).do_complete(); },
+            +[](state_base& s) -> allocator_type { return static_cast<Derived&>(s).do_get_allocator(); },
+            state_base::get_allocator_ptr_fn<Derived>(),
+            state_base::get_stop_token_fn<Derived>()};
+        return &table;
+    }
+    template <typename Derived>
+    static constexpr auto get_allocator_ptr_fn() noexcept -> const allocator_type* (*)(state_base&) {
+        if constexpr (requires(Derived& d) { d.do_get_allocator_ptr(); })
+            return +[](state_base& s) -> const allocator_type* {
+                return static_cast<Derived&>(s).do_get_allocator_ptr();
+            };
+        else
+            return nullptr;
+    }
+    template <typename Derived>
+    static constexpr auto get_stop_token_fn() noexcept -> stop_token_type (*)(state_base&) {
+        if constexpr (requires(Derived& d) { d.do_get_stop_token(); })
+            return +[](state_base& s) -> stop_token_type { return static_cast<Derived&>(s).do_get_stop_token(); };
+        else
+            return nullptr;
+    }
 
-    virtual ~state_base() = default;
+    // sched_changed comes first to use the tail padding of a compact result.
+    bool             sched_changed{};
+    const vtable*    vtbl;
+    scheduler_type*  sched_ptr{};
+    Environment*     env_ptr{};
+    stop_token_type* token_ptr{};
 };
 } // namespace beman::task::detail
 
@@ -0,0 +1,67 @@
+// include/beman/task/detail/stop_forward.hpp                         -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_STOP_FORWARD
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_STOP_FORWARD
+
+#include <beman/execution/stop_token.hpp>
+#include <concepts>
+#include <optional>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Utility providing stop tokens of a source's type linked to an upstream stop token
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ * \internal
+ *
+ * If the upstream token has the token type of `StopSource` the upstream
+ * token is used directly and nothing is stored. Otherwise a stop source
+ * and a stop callback forwarding stop requests from the upstream token are
+ * only created when a token is requested and the upstream token can
+ * actually be stopped.
+ */
+template <typename UpstreamToken, typename StopSource>
+class stop_forward {
+  public:
+    using stop_token_type = decltype(::std::declval<StopSource&>().get_token());
+
+    auto get_token(const UpstreamToken& upstream) -> stop_token_type {
+        if constexpr (::std::default_initializable<stop_token_type>) {
+            if (not this->link && not upstream.stop_possible())
+                return stop_token_type{};
+        }
+        if (not this->link)
+            this->link.emplace(upstream);
+        return this->link->source.get_token();
+    }
+
+  private:
+    struct callback {
+        StopSource* source;
+        auto        operator()() const noexcept -> void { this->source->request_stop(); }
+    };
+    struct link_t {
+        StopSource                                                        source;
+        ::beman::execution::stop_callback_for_t<UpstreamToken, callback> forward;
+        explicit link_t(const UpstreamToken& upstream) : source(), forward(upstream, callback{&this->source}) {}
+    };
+
+    ::std::optional<link_t> link;
+};
+
+template <typename UpstreamToken, typename StopSource>
+    requires ::std::same_as<UpstreamToken, decltype(::std::declval<StopSource&>().get_token())>
+class stop_forward<UpstreamToken, StopSource> {
+  public:
+    using stop_token_type = UpstreamToken;
+
+    auto get_token(const UpstreamToken& upstream) const noexcept -> stop_token_type { return upstream; }
+};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
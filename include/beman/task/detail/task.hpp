@@ -35,12 +35,17 @@
 namespace beman::task::detail {
 
 struct default_environment {};
+template <typename>
+class expected_sender;
 
 template <typename Value = void, typename Env = default_environment>
 class task {
   private:
     template <typename Receiver>
     using state            = ::beman::task::detail::state<task, Value, Env, Receiver>;
+    template <typename ParentPromise>
+    using awaiter = ::beman::task::detail::
+        awaiter<Value, Env, ::beman::task::detail::promise_type<task, Value, Env>, ParentPromise>;
     using stop_source_type = ::beman::task::detail::stop_source_of_t<Env>;
     using stop_token_type  = decltype(std::declval<stop_source_type>().get_token());
 
@@ -62,6 +67,8 @@ class task {
 
     using promise_type = ::beman::task::detail::promise_type<task, Value, Env>;
     friend promise_type;
+    template <typename>
+    friend class ::beman::task::detail::expected_sender;
 
     task(const task&)                = delete;
     task(task&&) noexcept            = default;
@@ -76,9 +83,9 @@ class task {
         return state<std::remove_cvref_t<Receiver>>(std::forward<Receiver>(receiver), std::move(this->handle));
     }
     template <typename ParentPromise>
-    auto as_awaitable(ParentPromise&) && -> ::beman::task::detail::awaiter<Value, Env, promise_type, ParentPromise> {
+    auto as_awaitable(ParentPromise& parent) && -> awaiter<ParentPromise> {
         assert(this->handle.get());
-        return ::beman::task::detail::awaiter<Value, Env, promise_type, ParentPromise>(::std::move(this->handle));
+        return awaiter<ParentPromise>(::std::move(this->handle), parent);
     }
 
   private:
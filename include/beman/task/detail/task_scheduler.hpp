@@ -5,10 +5,20 @@
 #define INCLUDED_BEMAN_TASK_DETAIL_task_scheduler
 
 #include <beman/execution/execution.hpp>
+#include <beman/task/detail/can_run_inline.hpp>
+#include <beman/task/detail/chunked_bulk.hpp>
 #include <beman/task/detail/infallible_scheduler.hpp>
 #include <beman/task/detail/poly.hpp>
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <memory_resource>
 #include <new>
 #include <optional>
+#include <type_traits>
 #include <utility>
 
 // ----------------------------------------------------------------------------
@@ -25,6 +35,25 @@ namespace beman::task::detail {
  * forwards stop requests reported by the stop token obtained from the `connect`ed
  * receiver to the sender used by the underlying scheduler.
  *
+ * Schedulers, senders, and operation states too big for the internal buffers are
+ * allocated using a `std::pmr::polymorphic_allocator<std::byte>`. The allocator
+ * used for the scheduler is the one passed to the constructor: allocators convertible
+ * to `std::pmr::polymorphic_allocator<std::byte>` are used as is, other stateless
+ * allocators (e.g. `frame_pool_allocator`) are wrapped into a memory resource, and
+ * `std::allocator` uses the default memory resource. Other stateful allocators
+ * (e.g. `frame_arena_allocator`) are rejected: they would need to be kept alive
+ * by each copy of the scheduler.
+ * Senders obtained from `schedule()` use the scheduler's allocator. Operation states
+ * use the allocator of the receiver's environment if it is convertible and the
+ * sender's allocator otherwise.
+ *
+ * `bulk` senders whose scheduler is a `task_scheduler` are transformed to
+ * use the `bulk` implementation of the underlying scheduler: the indices are
+ * split into chunks and each chunk is processed by one call through the
+ * type-erased interface. Thus, parallel schedulers keep their parallelism. The
+ * number of chunks depends on the `parallelism` reported by the underlying
+ * scheduler; sequential schedulers process all indices as one chunk.
+ *
  * Completion signatures:
  *
  * - `ex::set_value_t()`
@@ -36,10 +65,71 @@ namespace beman::task::detail {
  *     auto sender{ex::schedule(sched) | some_sender};
  */
 class task_scheduler {
+  public:
+    using allocator_type = ::std::pmr::polymorphic_allocator<::std::byte>;
+
+  private:
+    // Memory resource forwarding to a stateless allocator which isn't a polymorphic_allocator.
+    template <typename Allocator>
+    class allocator_resource final : public ::std::pmr::memory_resource {
+        using byte_allocator = typename ::std::allocator_traits<Allocator>::template rebind_alloc<::std::byte>;
+        static constexpr std::size_t alignment{__STDCPP_DEFAULT_NEW_ALIGNMENT__};
+
+        auto do_allocate(std::size_t bytes, std::size_t align) -> void* override {
+            if (alignment < align)
+                return ::std::pmr::get_default_resource()->allocate(bytes, align);
+            byte_allocator alloc{};
+            return ::std::allocator_traits<byte_allocator>::allocate(alloc, bytes);
+        }
+        auto do_deallocate(void* ptr, std::size_t bytes, std::size_t align) -> void override {
+            if (alignment < align)
+                return ::std::pmr::get_default_resource()->deallocate(ptr, bytes, align);
+            byte_allocator alloc{};
+            ::std::allocator_traits<byte_allocator>::deallocate(alloc, static_cast<::std::byte*>(ptr), bytes);
+        }
+        auto do_is_equal(const ::std::pmr::memory_resource& other) const noexcept -> bool override {
+            return this == &other;
+        }
+
+      public:
+        static auto get() noexcept -> allocator_resource* {
+            static allocator_resource resource;
+            return &resource;
+        }
+    };
+
+    template <typename Allocator>
+    static auto make_allocator(const Allocator& alloc) -> allocator_type {
+        using byte_allocator = typename ::std::allocator_traits<Allocator>::template rebind_alloc<::std::byte>;
+        if constexpr (::std::constructible_from<allocator_type, const Allocator&>)
+            return allocator_type(alloc);
+        else if constexpr (::std::same_as<byte_allocator, ::std::allocator<::std::byte>>)
+            return allocator_type();
+        else {
+            static_assert(::std::is_empty_v<byte_allocator> && ::std::default_initializable<byte_allocator> &&
+                              ::std::allocator_traits<byte_allocator>::is_always_equal::value,
+                          "task_scheduler requires an allocator convertible to std::pmr::polymorphic_allocator "
+                          "or a stateless allocator");
+            return allocator_type(task_scheduler::allocator_resource<Allocator>::get());
+        }
+    }
+    template <typename Receiver>
+    static auto receiver_allocator(const Receiver& r, const allocator_type& alloc) -> allocator_type {
+        if constexpr (requires { allocator_type(::beman::execution::get_allocator(::beman::execution::get_env(r))); })
+            return allocator_type(::beman::execution::get_allocator(::beman::execution::get_env(r)));
+        else
+            return alloc;
+    }
+
     struct state_base {
         virtual ~state_base()         = default;
         virtual void complete_value() = 0;
     };
+    struct bulk_state_base : state_base {
+        virtual void run(std::size_t begin, std::size_t end) noexcept = 0;
+        virtual void complete_error(std::exception_ptr)             = 0;
+        virtual void complete_stopped()                             = 0;
+    };
 
     struct inner_state {
         struct receiver;
@@ -49,22 +139,41 @@ class task_scheduler {
             void        set_value() && noexcept { this->state->complete_value(); }
         };
         static_assert(::beman::execution::receiver<receiver>);
+        struct bulk_receiver {
+            using receiver_concept = ::beman::execution::receiver_tag;
+            bulk_state_base* state;
+            void             set_value() && noexcept { this->state->complete_value(); }
+            template <typename E>
+            void set_error(E&& e) && noexcept {
+                if constexpr (std::same_as<std::exception_ptr, std::remove_cvref_t<E>>)
+                    this->state->complete_error(std::forward<E>(e));
+                else
+                    this->state->complete_error(std::make_exception_ptr(std::forward<E>(e)));
+            }
+            void set_stopped() && noexcept { this->state->complete_stopped(); }
+        };
+        static_assert(::beman::execution::receiver<bulk_receiver>);
 
         struct base {
             virtual ~base()      = default;
             virtual void start() = 0;
         };
-        template <::beman::execution::sender Sender>
+        template <::beman::execution::sender Sender, ::beman::execution::receiver Receiver>
         struct concrete : base {
-            using state_t = decltype(::beman::execution::connect(std::declval<Sender>(), std::declval<receiver>()));
+            using state_t = decltype(::beman::execution::connect(std::declval<Sender>(), std::declval<Receiver>()));
             state_t state;
             template <::beman::execution::sender S>
-            concrete(S&& s, state_base* b) : state(::beman::execution::connect(std::forward<S>(s), receiver{b})) {}
+            concrete(S&& s, Receiver r) : state(::beman::execution::connect(std::forward<S>(s), std::move(r))) {}
             void start() override { ::beman::execution::start(state); }
         };
-        ::beman::task::detail::poly<base, 16u * sizeof(void*)> state;
-        template <::beman::execution::sender S>
-        inner_state(S&& s, state_base* b) : state(static_cast<concrete<S>*>(nullptr), std::forward<S>(s), b) {}
+        ::beman::task::detail::poly<base, 16u * sizeof(void*), allocator_type> state;
+        template <::beman::execution::sender S, ::beman::execution::receiver R>
+        inner_state(S&& s, R r, const allocator_type& alloc)
+            : state(::std::allocator_arg,
+                    alloc,
+                    static_cast<concrete<S, R>*>(nullptr),
+                    std::forward<S>(s),
+                    std::move(r)) {}
         void start() { this->state->start(); }
     };
 
@@ -75,7 +184,9 @@ class task_scheduler {
         inner_state                   s;
 
         template <::beman::execution::receiver R, typename PS>
-        state(R&& r, PS& ps) : receiver(std::forward<R>(r)), s(ps->connect(this)) {}
+        state(R&& r, PS& ps)
+            : receiver(std::forward<R>(r)),
+              s(ps->connect(this, task_scheduler::receiver_allocator(this->receiver, ps.get_allocator()))) {}
         void start() & noexcept { this->s.start(); }
         void complete_value() override { ::beman::execution::set_value(std::move(this->receiver)); }
     };
@@ -91,7 +202,7 @@ class task_scheduler {
       public:
         task_scheduler
         query(const ::beman::execution::get_completion_scheduler_t<::beman::execution::set_value_t>&) const noexcept {
-            return this->sndr->inner_sender->get_completion_scheduler();
+            return this->sndr->inner_sender->get_completion_scheduler(this->sndr->inner_sender.get_allocator());
         }
     };
 
@@ -101,11 +212,11 @@ class task_scheduler {
 
       private:
         struct base {
-            virtual ~base()                                         = default;
-            virtual base*          move(void*)                      = 0;
-            virtual base*          clone(void*) const               = 0;
-            virtual inner_state    connect(state_base*)             = 0;
-            virtual task_scheduler get_completion_scheduler() const = 0;
+            virtual ~base()                                                              = default;
+            virtual base*          move(void*)                                           = 0;
+            virtual base*          clone(void*) const                                    = 0;
+            virtual inner_state    connect(state_base*, const allocator_type&)            = 0;
+            virtual task_scheduler get_completion_scheduler(const allocator_type&) const = 0;
         };
         template <::beman::execution::scheduler Scheduler>
         struct concrete : base {
@@ -117,13 +228,16 @@ class task_scheduler {
             concrete(S&& s) : sender(::beman::execution::schedule(std::forward<S>(s))) {}
             base*          move(void* buffer) override { return new (buffer) concrete(std::move(*this)); }
             base*          clone(void* buffer) const override { return new (buffer) concrete(*this); }
-            inner_state    connect(state_base* b) override { return inner_state(::std::move(sender), b); }
-            task_scheduler get_completion_scheduler() const override {
+            inner_state    connect(state_base* b, const allocator_type& alloc) override {
+                return inner_state(::std::move(sender), inner_state::receiver{b}, alloc);
+            }
+            task_scheduler get_completion_scheduler(const allocator_type& alloc) const override {
                 return task_scheduler(::beman::execution::get_completion_scheduler<::beman::execution::set_value_t>(
-                    ::beman::execution::get_env(this->sender), this->sender));
+                                          ::beman::execution::get_env(this->sender), this->sender),
+                                      alloc);
             }
         };
-        poly<base, 4 * sizeof(void*)> inner_sender;
+        poly<base, 4 * sizeof(void*), allocator_type> inner_sender;
 
       public:
         using sender_concept        = ::beman::execution::sender_tag;
@@ -134,9 +248,11 @@ class task_scheduler {
         }
 
         template <::beman::execution::scheduler S>
-        explicit sender(S&& s) : inner_sender(static_cast<concrete<S>*>(nullptr), std::forward<S>(s)) {}
-        sender(sender&&)      = default;
-        sender(const sender&) = default;
+        sender(S&& s, const allocator_type& alloc)
+            : inner_sender(::std::allocator_arg, alloc, static_cast<concrete<S>*>(nullptr), std::forward<S>(s)) {}
+        sender(sender&&) = default;
+        sender(const sender& other)
+            : inner_sender(::std::allocator_arg, other.inner_sender.get_allocator(), other.inner_sender) {}
 
         template <::beman::execution::receiver R>
         state<R> connect(R&& r) {
@@ -148,11 +264,24 @@ class task_scheduler {
 
     // scheduler implementation
     struct base {
-        virtual ~base()                          = default;
-        virtual sender schedule()                = 0;
-        virtual base*  move(void* buffer)        = 0;
-        virtual base*  clone(void*) const        = 0;
-        virtual bool   equals(const base*) const = 0;
+        virtual ~base()                                                                      = default;
+        virtual sender      schedule(const allocator_type&)                                  = 0;
+        virtual inner_state bulk(std::size_t, bulk_state_base*, const allocator_type&) const = 0;
+        virtual base*       move(void* buffer)                                               = 0;
+        virtual base*       clone(void*) const                                               = 0;
+        virtual bool        equals(const base*) const                                        = 0;
+        virtual bool        can_run_inline() const noexcept                                  = 0;
+        virtual std::size_t parallelism() const noexcept                                     = 0;
+    };
+    // Processes one chunk of a bulk operation; used as the function of the underlying bulk.
+    struct bulk_chunk {
+        bulk_state_base* state;
+        std::size_t      shape;
+        std::size_t      chunks;
+        void             operator()(std::size_t index) const noexcept {
+            auto [begin, end]{::beman::task::detail::chunk_range(index, this->shape, this->chunks)};
+            this->state->run(begin, end);
+        }
     };
     template <::beman::execution::scheduler Scheduler>
     struct concrete : base {
@@ -160,39 +289,187 @@ class task_scheduler {
         template <typename S>
             requires ::beman::execution::scheduler<::std::remove_cvref_t<S>>
         explicit concrete(S&& s) : scheduler(std::forward<S>(s)) {}
-        sender schedule() override { return sender(this->scheduler); }
-        base*  move(void* buffer) override { return new (buffer) concrete(std::move(*this)); }
-        base*  clone(void* buffer) const override { return new (buffer) concrete(*this); }
-        bool   equals(const base* o) const override {
-            auto other{dynamic_cast<const concrete*>(o)};
-            return other ? this->scheduler == other->scheduler : false;
+        sender      schedule(const allocator_type& alloc) override { return sender(this->scheduler, alloc); }
+        inner_state bulk(std::size_t shape, bulk_state_base* b, const allocator_type& alloc) const override {
+            // Without parallelism chunking only adds overhead: use a single chunk.
+            const std::size_t threads{::beman::task::detail::parallelism(this->scheduler)};
+            const std::size_t chunks{threads == 1u ? std::min(shape, std::size_t(1u))
+                                                   : ::beman::task::detail::chunk_count(shape, threads)};
+            auto              sched{this->scheduler};
+            return inner_state(::beman::execution::bulk(::beman::execution::schedule(sched),
+                                                        chunks,
+                                                        bulk_chunk{b, shape, chunks}),
+                               inner_state::bulk_receiver{b},
+                               alloc);
+        }
+        base* move(void* buffer) override { return new (buffer) concrete(std::move(*this)); }
+        base* clone(void* buffer) const override { return new (buffer) concrete(*this); }
+        // precondition: o refers to a concrete<Scheduler>, i.e., the type tags are identical
+        bool equals(const base* o) const override {
+            return this->scheduler == static_cast<const concrete*>(o)->scheduler;
+        }
+        bool can_run_inline() const noexcept override {
+            return ::beman::task::detail::can_run_inline(this->scheduler);
+        }
+        std::size_t parallelism() const noexcept override {
+            return ::beman::task::detail::parallelism(this->scheduler);
+        }
+    };
+    using scheduler_poly = poly<base, 4 * sizeof(void*), allocator_type>;
+
+    // bulk implementation
+    template <typename Fun, ::beman::execution::receiver Receiver>
+    struct bulk_state : bulk_state_base {
+        using operation_state_concept = ::beman::execution::operation_state_tag;
+        std::remove_cvref_t<Receiver> receiver;
+        Fun                           fun;
+        std::atomic<bool>             failed{};
+        std::exception_ptr            error{};
+        inner_state                   s;
+
+        template <::beman::execution::receiver R>
+        bulk_state(R&& r, Fun&& f, const scheduler_poly& sched, std::size_t shape)
+            : receiver(std::forward<R>(r)),
+              fun(std::move(f)),
+              s(sched->bulk(shape, this, task_scheduler::receiver_allocator(this->receiver, sched.get_allocator()))) {}
+        void start() & noexcept { this->s.start(); }
+        void run(std::size_t begin, std::size_t end) noexcept override {
+            try {
+                this->fun(begin, end);
+            } catch (...) {
+                if (not this->failed.exchange(true))
+                    this->error = std::current_exception();
+            }
         }
+        void complete_value() override {
+            if (this->failed.load())
+                ::beman::execution::set_error(std::move(this->receiver), std::move(this->error));
+            else
+                ::beman::execution::set_value(std::move(this->receiver));
+        }
+        void complete_error(std::exception_ptr e) override {
+            ::beman::execution::set_error(std::move(this->receiver), std::move(e));
+        }
+        void complete_stopped() override { ::beman::execution::set_stopped(std::move(this->receiver)); }
     };
 
-    poly<base, 4 * sizeof(void*)> scheduler;
+    template <typename Child, typename Env>
+    static auto bulk_scheduler(const Child& child, const Env& env) -> task_scheduler {
+        if constexpr (requires {
+                          {
+                              ::beman::execution::get_completion_scheduler<::beman::execution::set_value_t>(
+                                  ::beman::execution::get_env(child))
+                          } -> std::same_as<task_scheduler>;
+                      })
+            return ::beman::execution::get_completion_scheduler<::beman::execution::set_value_t>(
+                ::beman::execution::get_env(child));
+        else
+            return task_scheduler(::beman::execution::get_scheduler(env));
+    }
+
+    // The address of type_tag<S> identifies the type of the erased scheduler. The tag is
+    // deliberately writable: identical read-only constants may be folded by the linker.
+    template <typename>
+    static inline char type_tag{};
+
+    const void*    tag;
+    scheduler_poly scheduler;
 
   public:
     using scheduler_concept = ::beman::execution::scheduler_tag;
 
+    /*!
+     * \brief Sender calling `fun(begin, end)` for chunks of `[0, shape)` using the underlying scheduler's `bulk`
+     */
+    template <typename Fun>
+    class bulk_sender {
+        friend class task_scheduler;
+
+      private:
+        scheduler_poly sched;
+        std::size_t    shape;
+        Fun            fun;
+
+        bulk_sender(const scheduler_poly& s, std::size_t n, Fun f)
+            : sched(::std::allocator_arg, s.get_allocator(), s), shape(n), fun(std::move(f)) {}
+
+      public:
+        using sender_concept        = ::beman::execution::sender_tag;
+        using completion_signatures = ::beman::execution::completion_signatures<::beman::execution::set_value_t(),
+                                                                                ::beman::execution::set_error_t(
+                                                                                    std::exception_ptr),
+                                                                                ::beman::execution::set_stopped_t()>;
+        template <typename...>
+        static consteval auto get_completion_signatures() noexcept -> completion_signatures {
+            return {};
+        }
+
+        template <::beman::execution::receiver R>
+        auto connect(R&& r) && -> bulk_state<Fun, R> {
+            return bulk_state<Fun, R>(std::forward<R>(r), std::move(this->fun), this->sched, this->shape);
+        }
+        template <::beman::execution::receiver R>
+            requires ::std::copy_constructible<Fun>
+        auto connect(R&& r) const& -> bulk_state<Fun, R> {
+            return bulk_state<Fun, R>(std::forward<R>(r), Fun(this->fun), this->sched, this->shape);
+        }
+    };
+
+    /*!
+     * \brief Domain transforming `bulk` senders to use the underlying scheduler's `bulk`
+     */
+    struct domain {
+        template <::beman::execution::sender Sndr, typename Env>
+            requires ::std::same_as<::beman::execution::tag_of_t<::std::remove_cvref_t<Sndr>>,
+                                    ::beman::execution::bulk_t>
+        auto transform_sender(Sndr&& sndr, const Env& env) const {
+            return ::beman::task::detail::chunked_bulk(::std::forward<Sndr>(sndr), [&env](const auto& child) {
+                return [sched = task_scheduler::bulk_scheduler(child, env)](std::size_t shape, auto body) {
+                    return sched.bulk_chunked(shape, std::move(body));
+                };
+            });
+        }
+    };
+
     template <typename S, typename Allocator = ::std::allocator<void>>
         requires(not std::same_as<task_scheduler, std::remove_cvref_t<S>>) &&
                 ::beman::execution::scheduler<::std::remove_cvref_t<S>> &&
                 ::beman::task::detail::infallible_scheduler<::std::remove_cvref_t<S>, ::beman::execution::env<>>
-    explicit task_scheduler(S&& s, Allocator = {})
-        : scheduler(static_cast<concrete<std::decay_t<S>>*>(nullptr), std::forward<S>(s)) {}
-    task_scheduler(task_scheduler&&)      = default;
-    task_scheduler(const task_scheduler&) = default;
+    explicit task_scheduler(S&& s, const Allocator& alloc = {})
+        : tag(&type_tag<std::decay_t<S>>),
+          scheduler(::std::allocator_arg,
+                    task_scheduler::make_allocator(alloc),
+                    static_cast<concrete<std::decay_t<S>>*>(nullptr),
+                    std::forward<S>(s)) {}
+    task_scheduler(task_scheduler&&) = default;
+    task_scheduler(const task_scheduler& other) : task_scheduler(other, other.get_allocator()) {}
     template <typename Allocator>
-    task_scheduler(const task_scheduler& other, Allocator) : scheduler(other.scheduler) {}
+    task_scheduler(const task_scheduler& other, const Allocator& alloc)
+        : tag(other.tag), scheduler(::std::allocator_arg, task_scheduler::make_allocator(alloc), other.scheduler) {}
     task_scheduler& operator=(const task_scheduler&) = default;
     ~task_scheduler()                                = default;
 
-    sender schedule() { return this->scheduler->schedule(); }
-    bool   operator==(const task_scheduler&) const = default;
+    auto   get_allocator() const noexcept -> allocator_type { return this->scheduler.get_allocator(); }
+    sender schedule() { return this->scheduler->schedule(this->scheduler.get_allocator()); }
+    template <typename Fun>
+    auto bulk_chunked(std::size_t shape, Fun fun) const -> bulk_sender<Fun> {
+        return bulk_sender<Fun>(this->scheduler, shape, std::move(fun));
+    }
+    auto query(const ::beman::execution::get_domain_t&) const noexcept -> domain { return {}; }
+    auto query(const ::beman::task::detail::can_run_inline_t&) const noexcept -> bool {
+        return this->scheduler->can_run_inline();
+    }
+    auto query(const ::beman::task::detail::parallelism_t&) const noexcept -> std::size_t {
+        return this->scheduler->parallelism();
+    }
+    bool   operator==(const task_scheduler& other) const {
+        return this->tag == other.tag && this->scheduler->equals(other.scheduler.operator->());
+    }
     template <typename Sched>
         requires(not ::std::same_as<task_scheduler, Sched>) && ::beman::execution::scheduler<Sched>
-    bool operator==(const Sched& other [[maybe_unused]]) const {
-        return *this == task_scheduler(other);
+    bool operator==(const Sched& other) const {
+        return this->tag == &type_tag<Sched> &&
+               static_cast<const concrete<Sched>*>(this->scheduler.operator->())->scheduler == other;
     }
 };
 static_assert(::beman::execution::scheduler<task_scheduler>);
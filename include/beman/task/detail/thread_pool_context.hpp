@@ -0,0 +1,267 @@
+// include/beman/task/detail/thread_pool_context.hpp                  -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_THREAD_POOL_CONTEXT
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_THREAD_POOL_CONTEXT
+
+#include <beman/execution/execution.hpp>
+#include <beman/task/detail/can_run_inline.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Context processing work on a fixed number of threads sharing one queue
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * All work is put into one FIFO queue shared by the worker threads. The
+ * queue is an intrusive list protected by a mutex which is also used to
+ * park idle workers: they are only woken when work is scheduled. Under
+ * heavy contention `work_stealing_context` is the better choice. Optionally,
+ * each worker is pinned to a CPU (currently only supported on Linux; on
+ * other systems the threads aren't pinned). Like for
+ * `single_thread_context` the destructor calls `finish()` and joins the
+ * threads, i.e., all scheduled work is processed before the context is
+ * destroyed. Work must not be scheduled after `finish()` was called.
+ *
+ * The scheduler completes with `set_value_t()` only and can, thus, be used
+ * with `task_scheduler` and as `scheduler_type` of a task's environment.
+ * On the worker threads `can_run_inline` reports `true` for the scheduler.
+ */
+class thread_pool_context {
+  private:
+    struct work {
+        work()                              = default;
+        work(work&&)                        = delete;
+        work(const work&)                   = delete;
+        work&        operator=(work&&)      = delete;
+        work&        operator=(const work&) = delete;
+        virtual void execute() noexcept     = 0;
+
+        work* next{};
+
+      protected:
+        ~work() = default;
+    };
+
+    template <::beman::execution::receiver Receiver>
+    struct state final : work {
+        using operation_state_concept = ::beman::execution::operation_state_tag;
+        thread_pool_context* context;
+        Receiver             receiver;
+
+        template <::beman::execution::receiver R>
+        state(thread_pool_context* c, R&& r) : context(c), receiver(std::forward<R>(r)) {}
+        auto start() & noexcept -> void { this->context->submit(this); }
+        auto execute() noexcept -> void override { ::beman::execution::set_value(std::move(this->receiver)); }
+    };
+
+  public:
+    /*!
+     * \brief Configuration of the threads
+     *
+     * If `pin` is `true` worker `i` is pinned to CPU `cpus[i % cpus.size()]`
+     * or, if `cpus` is empty, to CPU `i % std::thread::hardware_concurrency()`.
+     * Pinning a worker fails, e.g., if the CPU isn't available to the process.
+     * Such a worker runs unpinned and `pinned()` reports how many workers were
+     * actually pinned.
+     */
+    struct options {
+        std::size_t              threads{thread_pool_context::default_threads()};
+        bool                     pin{};
+        std::vector<std::size_t> cpus{};
+    };
+
+    class scheduler;
+    class env {
+        friend class thread_pool_context;
+
+      private:
+        thread_pool_context* context;
+        explicit env(thread_pool_context* c) noexcept : context(c) {}
+
+      public:
+        auto query(const ::beman::execution::get_completion_scheduler_t<::beman::execution::set_value_t>&)
+            const noexcept -> scheduler;
+    };
+    class sender {
+        friend class scheduler;
+
+      private:
+        thread_pool_context* context;
+        explicit sender(thread_pool_context* c) noexcept : context(c) {}
+
+      public:
+        using sender_concept        = ::beman::execution::sender_tag;
+        using completion_signatures = ::beman::execution::completion_signatures<::beman::execution::set_value_t()>;
+        template <typename...>
+        static consteval auto get_completion_signatures() noexcept -> completion_signatures {
+            return {};
+        }
+
+        template <::beman::execution::receiver Receiver>
+        auto connect(Receiver&& receiver) const -> state<std::remove_cvref_t<Receiver>> {
+            return state<std::remove_cvref_t<Receiver>>(this->context, std::forward<Receiver>(receiver));
+        }
+        auto get_env() const noexcept -> env { return env(this->context); }
+    };
+    class scheduler {
+        friend class thread_pool_context;
+
+      private:
+        thread_pool_context* context;
+        explicit scheduler(thread_pool_context* c) noexcept : context(c) {}
+
+      public:
+        using scheduler_concept = ::beman::execution::scheduler_tag;
+
+        auto schedule() const noexcept -> sender { return sender(this->context); }
+        auto query(const ::beman::task::detail::can_run_inline_t&) const noexcept -> bool {
+            return thread_pool_context::current() == this->context;
+        }
+        auto operator==(const scheduler&) const noexcept -> bool = default;
+    };
+
+    explicit thread_pool_context(std::size_t threads = thread_pool_context::default_threads())
+        : thread_pool_context(options{threads}) {}
+    explicit thread_pool_context(const options& opts) {
+        const std::size_t threads{std::max(std::size_t(1u), opts.threads)};
+        std::latch        started(static_cast<std::ptrdiff_t>(threads));
+        try {
+            this->threads.reserve(threads);
+            for (std::size_t i{}; i != threads; ++i) {
+                const std::size_t cpu{opts.cpus.empty() ? i % thread_pool_context::default_threads()
+                                                        : opts.cpus[i % opts.cpus.size()]};
+                this->threads.emplace_back([this, &started, pin = opts.pin, cpu] {
+                    if (pin && thread_pool_context::pin_current_thread(cpu))
+                        ++this->pinned_threads;
+                    started.count_down();
+                    this->run();
+                });
+            }
+        } catch (...) {
+            // The started workers refer to the latch: let them exit before it is destroyed.
+            this->finish();
+            started.count_down(static_cast<std::ptrdiff_t>(threads - this->threads.size()));
+            for (auto& t : this->threads)
+                t.join();
+            throw;
+        }
+        // Wait for the pinning to be done such that pinned() is accurate.
+        started.wait();
+    }
+    thread_pool_context(thread_pool_context&&)                 = delete;
+    thread_pool_context(const thread_pool_context&)            = delete;
+    thread_pool_context& operator=(thread_pool_context&&)      = delete;
+    thread_pool_context& operator=(const thread_pool_context&) = delete;
+    ~thread_pool_context() {
+        this->finish();
+        for (auto& t : this->threads)
+            t.join();
+    }
+
+    auto get_scheduler() noexcept -> scheduler { return scheduler(this); }
+    auto size() const noexcept -> std::size_t { return this->threads.size(); }
+    /*!
+     * \brief Get the number of workers which were successfully pinned to a CPU
+     */
+    auto pinned() const noexcept -> std::size_t { return this->pinned_threads; }
+    /*!
+     * \brief Let the workers exit once there is no more work.
+     */
+    auto finish() -> void {
+        {
+            std::lock_guard cerberus(this->mutex);
+            this->stopping = true;
+        }
+        this->condition.notify_all();
+    }
+
+    static auto default_threads() noexcept -> std::size_t { return std::max(1u, std::thread::hardware_concurrency()); }
+
+  private:
+    std::mutex               mutex;
+    std::condition_variable  condition;
+    work*                    head{};
+    work*                    tail{};
+    std::size_t              sleepers{};
+    bool                     stopping{};
+    std::atomic<std::size_t> pinned_threads{};
+    std::vector<std::thread> threads;
+
+    static auto current() noexcept -> thread_pool_context*& {
+        static thread_local thread_pool_context* rc{};
+        return rc;
+    }
+    static auto pin_current_thread([[maybe_unused]] std::size_t cpu) noexcept -> bool {
+#if defined(__linux__)
+        if (CPU_SETSIZE <= cpu)
+            return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    auto submit(work* w) noexcept -> void {
+        bool wake{};
+        {
+            std::lock_guard cerberus(this->mutex);
+            w->next = nullptr;
+            (this->tail ? this->tail->next : this->head) = w;
+            this->tail                                   = w;
+            wake                                         = 0u < this->sleepers;
+        }
+        if (wake)
+            this->condition.notify_one();
+    }
+    auto run() -> void {
+        current() = this;
+        std::unique_lock cerberus(this->mutex);
+        while (true) {
+            if (work* w{this->head}) {
+                this->head = w->next;
+                if (this->head == nullptr)
+                    this->tail = nullptr;
+                cerberus.unlock();
+                w->execute();
+                cerberus.lock();
+            } else if (this->stopping)
+                break;
+            else {
+                ++this->sleepers;
+                this->condition.wait(cerberus);
+                --this->sleepers;
+            }
+        }
+        current() = nullptr;
+    }
+};
+
+inline auto thread_pool_context::env::query(
+    const ::beman::execution::get_completion_scheduler_t<::beman::execution::set_value_t>&) const noexcept
+    -> scheduler {
+    return scheduler(this->context);
+}
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
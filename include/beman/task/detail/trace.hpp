@@ -0,0 +1,270 @@
+// include/beman/task/detail/trace.hpp                                -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_TRACE
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_TRACE
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Events recorded by the task tracing hooks
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ */
+enum class trace_event : unsigned char {
+    create,     //!< a task's coroutine frame was created
+    start,      //!< a task was started by a receiver or an awaiting task
+    suspend,    //!< a task suspended on `co_await`
+    resume,     //!< a task resumed after `co_await`
+    reschedule, //!< an awaited task completed on a different scheduler and its parent is rescheduled
+    complete,   //!< a task reached its final suspend point, i.e., its result is delivered next
+    destroy     //!< a task's coroutine frame is destroyed
+};
+
+/*!
+ * \brief Low overhead tracing of task events
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * When `BEMAN_TASK_TRACE` is defined (consistently for all translation
+ * units) tasks report the `trace_event`s together with the address of
+ * their promise. Each event is stored with a timestamp in a ring buffer
+ * of the reporting thread: recording an event doesn't lock and doesn't
+ * allocate (except when the first event of a thread is recorded; if that
+ * allocation fails the thread's events are dropped). If a thread records
+ * more than `capacity` events without these being collected the oldest
+ * events are overwritten. The buffer of an exited thread is released once
+ * its events were collected or cleared. At most `max_exited` buffers of
+ * exited threads are kept: beyond that the buffer of an exited thread is
+ * reused for a new thread, discarding its events. Additionally a hook can
+ * be installed which is called for each event.
+ *
+ * The recorded events can be retrieved from any thread using `collect()`
+ * or written as Chrome trace JSON (which can be loaded into Perfetto)
+ * using `export_chrome()`. Without the macro the hooks in the task
+ * implementation are compiled out.
+ */
+class trace {
+  public:
+#if defined(BEMAN_TASK_TRACE)
+    static constexpr bool enabled{true};
+#else
+    static constexpr bool enabled{false};
+#endif
+    static constexpr std::size_t capacity{std::size_t(1u) << 14u};
+    static constexpr std::size_t max_exited{16u};
+
+    using hook_type = void (*)(::beman::task::detail::trace_event, const void*) noexcept;
+
+    struct record {
+        std::uint64_t                      time{}; //!< steady clock time in nanoseconds
+        const void*                        task{};
+        ::beman::task::detail::trace_event event{};
+    };
+    struct thread_records {
+        std::size_t         thread{};  //!< small number identifying the recording thread
+        std::size_t         dropped{}; //!< number of events overwritten before being collected
+        std::vector<record> records;
+    };
+
+    static auto emit(::beman::task::detail::trace_event event, const void* task) noexcept -> void {
+        if constexpr (trace::enabled) {
+            if (buffer* b{trace::local()}) {
+                std::uint64_t index{b->head.load(std::memory_order_relaxed)};
+                slot&         s{b->slots[index % capacity]};
+                // Readers check the head after reading the slots to detect slots overwritten while being read.
+                std::atomic_thread_fence(std::memory_order_release);
+                s.time.store(trace::now(), std::memory_order_relaxed);
+                s.task.store(task, std::memory_order_relaxed);
+                s.event.store(event, std::memory_order_relaxed);
+                b->head.store(index + 1u, std::memory_order_release);
+            }
+            if (hook_type h{trace::hook().load(std::memory_order_acquire)})
+                h(event, task);
+        }
+    }
+    /*!
+     * \brief Install a hook called for each event and return the previous hook
+     */
+    static auto set_hook(hook_type h) noexcept -> hook_type { return trace::hook().exchange(h); }
+
+    /*!
+     * \brief Get the events recorded since the last call of `collect()` or `clear()`
+     */
+    static auto collect() -> std::vector<thread_records> {
+        std::vector<thread_records> rc;
+        registry&                   r{trace::get_registry()};
+        std::lock_guard             cerberus(r.lock);
+        for (const std::shared_ptr<buffer>& b : r.buffers) {
+            thread_records& tr{rc.emplace_back(thread_records{b->thread, 0u, {}})};
+            std::uint64_t   begin{b->tail};
+            std::uint64_t   end{b->head.load(std::memory_order_acquire)};
+            begin = std::max(begin, end < capacity ? std::uint64_t() : end - capacity);
+            tr.records.reserve(end - begin);
+            for (std::uint64_t i{begin}; i != end; ++i) {
+                const slot& s{b->slots[i % capacity]};
+                tr.records.push_back(record{s.time.load(std::memory_order_relaxed),
+                                            s.task.load(std::memory_order_relaxed),
+                                            s.event.load(std::memory_order_relaxed)});
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::uint64_t current{b->head.load(std::memory_order_relaxed)};
+            std::uint64_t valid{current < capacity ? std::uint64_t() : current - capacity + 1u};
+            if (begin < valid) {
+                std::size_t torn{std::size_t(std::min(valid, end) - begin)};
+                tr.records.erase(tr.records.begin(), tr.records.begin() + std::ptrdiff_t(torn));
+            }
+            tr.dropped = std::size_t(std::max(begin, valid) - b->tail);
+            b->tail    = end;
+        }
+        trace::release_exited(r);
+        return rc;
+    }
+    /*!
+     * \brief Discard all events recorded so far
+     */
+    static auto clear() -> void {
+        registry&       r{trace::get_registry()};
+        std::lock_guard cerberus(r.lock);
+        for (const std::shared_ptr<buffer>& b : r.buffers)
+            b->tail = b->head.load(std::memory_order_acquire);
+        trace::release_exited(r);
+    }
+    /*!
+     * \brief Collect the events and write them as Chrome trace JSON to `out`
+     *
+     * Each task is shown as an asynchronous slice from `start` to
+     * `complete`. The other events are shown as instant events on the
+     * thread recording them.
+     */
+    static auto export_chrome(std::ostream& out) -> void {
+        std::vector<thread_records> threads{trace::collect()};
+        std::uint64_t               origin{~std::uint64_t()};
+        for (const thread_records& t : threads)
+            for (const record& r : t.records)
+                origin = std::min(origin, r.time);
+
+        out << "{\"traceEvents\":[";
+        const char* sep{"\n"};
+        for (const thread_records& t : threads) {
+            for (const record& r : t.records) {
+                const std::uint64_t ns{r.time - origin};
+                const char*         label{r.event == trace_event::start || r.event == trace_event::complete
+                                             ? "task"
+                                             : trace::name(r.event)};
+                out << sep << "{\"name\":\"" << label << "\",\"cat\":\"task\",\"pid\":1,\"tid\":" << t.thread
+                    << ",\"ts\":" << ns / 1000u << "." << char('0' + ns / 100u % 10u) << char('0' + ns / 10u % 10u)
+                    << char('0' + ns % 10u);
+                switch (r.event) {
+                case trace_event::start:
+                    out << ",\"ph\":\"b\",\"id\":\"" << r.task << "\"}";
+                    break;
+                case trace_event::complete:
+                    out << ",\"ph\":\"e\",\"id\":\"" << r.task << "\"}";
+                    break;
+                default:
+                    out << ",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"task\":\"" << r.task << "\"}}";
+                    break;
+                }
+                sep = ",\n";
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    static constexpr auto name(::beman::task::detail::trace_event event) noexcept -> const char* {
+        constexpr const char* names[]{"create", "start", "suspend", "resume", "reschedule", "complete", "destroy"};
+        return names[static_cast<std::size_t>(event)];
+    }
+
+  private:
+    struct slot {
+        std::atomic<std::uint64_t>                      time{};
+        std::atomic<const void*>                        task{};
+        std::atomic<::beman::task::detail::trace_event> event{};
+    };
+    struct buffer {
+        explicit buffer(std::size_t t) : thread(t) {}
+        std::size_t                 thread; // protected by the registry's lock
+        std::atomic<std::uint64_t>  head{};
+        std::uint64_t               tail{}; // protected by the registry's lock
+        std::atomic<bool>           exited{};
+        std::array<slot, capacity>  slots{};
+    };
+    struct registry {
+        std::mutex                           lock;
+        std::vector<std::shared_ptr<buffer>> buffers;
+        std::size_t                          next_thread{};
+    };
+    // Marks the thread's buffer as exited when the thread ends.
+    struct owner {
+        buffer* b;
+        ~owner() {
+            if (this->b)
+                this->b->exited.store(true, std::memory_order_release);
+        }
+    };
+
+    static auto now() noexcept -> std::uint64_t {
+        return std::uint64_t(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+    static auto hook() noexcept -> std::atomic<hook_type>& {
+        static std::atomic<hook_type> rc{};
+        return rc;
+    }
+    static auto get_registry() -> registry& {
+        static registry rc;
+        return rc;
+    }
+    // The registry keeps the buffer alive after the thread exited to allow collecting its events.
+    static auto local() noexcept -> buffer* {
+        thread_local owner rc{trace::register_thread()};
+        return rc.b;
+    }
+    static auto register_thread() noexcept -> buffer* {
+        try {
+            registry&       r{trace::get_registry()};
+            std::lock_guard cerberus(r.lock);
+            auto            exited{[](const std::shared_ptr<buffer>& b) {
+                return b->exited.load(std::memory_order_acquire);
+            }};
+            if (max_exited <= std::size_t(std::count_if(r.buffers.begin(), r.buffers.end(), exited))) {
+                // Reuse the oldest buffer of an exited thread, discarding its events.
+                buffer& b{**std::find_if(r.buffers.begin(), r.buffers.end(), exited)};
+                b.thread = r.next_thread++;
+                b.tail   = b.head.load(std::memory_order_relaxed);
+                b.exited.store(false, std::memory_order_relaxed);
+                return &b;
+            }
+            r.buffers.push_back(std::make_shared<buffer>(r.next_thread));
+            ++r.next_thread;
+            return r.buffers.back().get();
+        } catch (...) {
+            return nullptr;
+        }
+    }
+    // Release the buffers of exited threads whose events were all collected; the lock needs to be held.
+    static auto release_exited(registry& r) noexcept -> void {
+        std::erase_if(r.buffers, [](const std::shared_ptr<buffer>& b) {
+            return b->exited.load(std::memory_order_acquire) && b->tail == b->head.load(std::memory_order_relaxed);
+        });
+    }
+};
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,543 @@
+// include/beman/task/detail/work_stealing_context.hpp                -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_WORK_STEALING_CONTEXT
+#define INCLUDED_INCLUDE_BEMAN_TASK_DETAIL_WORK_STEALING_CONTEXT
+
+#include <beman/execution/execution.hpp>
+#include <beman/task/detail/chunked_bulk.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace beman::task::detail {
+/*!
+ * \brief Thread pool distributing work between its threads using work stealing
+ * \headerfile beman/task.hpp <beman/task.hpp>
+ *
+ * Each worker thread owns a fixed size Chase-Lev deque and a LIFO slot.
+ * Work scheduled from a worker thread goes into the LIFO slot of that
+ * worker, pushing a previously stored item into the worker's deque. Work
+ * scheduled from other threads goes into a shared injection queue (as does
+ * work which doesn't fit into a full deque). A worker looks for work in its
+ * LIFO slot, its own deque, the injection queue, and finally tries to steal
+ * from the other workers. Workers without work spin for a bit before they
+ * are parked until new work is scheduled.
+ *
+ * The scheduler completes with `set_value_t()` only and can, thus, be used
+ * with `task_scheduler` and as `scheduler_type` of a task's environment.
+ * Work must not be scheduled after `finish()` was called.
+ *
+ * `bulk` senders running on the context are transformed to split the
+ * indices into chunks which are processed by up to one item per worker.
+ */
+class work_stealing_context {
+  public:
+    class scheduler;
+
+  private:
+    /*!
+     * \brief Base of the operation states scheduled on the context
+     */
+    struct work {
+        work()                              = default;
+        work(work&&)                        = delete;
+        work(const work&)                   = delete;
+        work&        operator=(work&&)      = delete;
+        work&        operator=(const work&) = delete;
+        virtual void execute() noexcept     = 0;
+
+        work* next{};
+
+      protected:
+        ~work() = default;
+    };
+
+    /*!
+     * \brief Fixed capacity Chase-Lev deque; push and pop are owner only.
+     */
+    class deque {
+      public:
+        static constexpr std::int64_t capacity{256};
+
+        auto push(work* w) noexcept -> bool {
+            std::int64_t b{this->bottom.load(std::memory_order_relaxed)};
+            std::int64_t t{this->top.load(std::memory_order_acquire)};
+            if (capacity <= b - t)
+                return false;
+            this->buffer[std::size_t(b & (capacity - 1))].store(w, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            this->bottom.store(b + 1, std::memory_order_relaxed);
+            return true;
+        }
+        auto pop() noexcept -> work* {
+            std::int64_t b{this->bottom.load(std::memory_order_relaxed) - 1};
+            this->bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t{this->top.load(std::memory_order_relaxed)};
+            if (b < t) {
+                this->bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            work* rc{this->buffer[std::size_t(b & (capacity - 1))].load(std::memory_order_relaxed)};
+            if (t == b) {
+                if (not this->top.compare_exchange_strong(
+                        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    rc = nullptr;
+                this->bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return rc;
+        }
+        auto steal() noexcept -> work* {
+            std::int64_t t{this->top.load(std::memory_order_acquire)};
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t b{this->bottom.load(std::memory_order_acquire)};
+            if (b <= t)
+                return nullptr;
+            work* rc{this->buffer[std::size_t(t & (capacity - 1))].load(std::memory_order_relaxed)};
+            return this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)
+                       ? rc
+                       : nullptr;
+        }
+      private:
+        alignas(64) std::atomic<std::int64_t> top{};
+        alignas(64) std::atomic<std::int64_t> bottom{};
+        std::array<std::atomic<work*>, std::size_t(capacity)> buffer{};
+    };
+
+    struct worker {
+        work_stealing_context* owner;
+        std::uint32_t          seed;
+        deque                  queue{};
+        std::atomic<work*>     lifo{};
+        std::size_t            lifo_runs{};
+        std::size_t            tick{};
+        std::thread            thread{};
+    };
+
+    static constexpr std::size_t spin_rounds{64u};
+    //! Limit of consecutive LIFO slot runs to avoid starving the deque
+    static constexpr std::size_t lifo_limit{16u};
+    //! The injection queue is checked first every this many runs
+    static constexpr std::size_t injection_interval{61u};
+    //! Maximum number of items moved from the injection queue in one go
+    static constexpr std::size_t injection_batch{32u};
+
+    std::vector<std::unique_ptr<worker>> workers;
+    std::mutex                           mutex;
+    std::condition_variable              condition;
+    work*                                injection_head{};
+    work*                                injection_tail{};
+    std::atomic<std::size_t>             injected{};
+    std::atomic<std::size_t>             sleepers{};
+    std::atomic<std::uint64_t>           epoch{};
+    std::atomic<bool>                    stopping{};
+
+    static auto current() noexcept -> worker*& {
+        thread_local worker* rc{};
+        return rc;
+    }
+
+    auto inject(work* w) noexcept -> void {
+        std::lock_guard cerberus(this->mutex);
+        w->next = nullptr;
+        (this->injection_tail ? this->injection_tail->next : this->injection_head) = w;
+        this->injection_tail                                                      = w;
+        this->injected.fetch_add(1u, std::memory_order_relaxed);
+    }
+    auto take_injected(worker& self) noexcept -> work* {
+        if (this->injected.load(std::memory_order_relaxed) == 0u)
+            return nullptr;
+        std::lock_guard cerberus(this->mutex);
+        work*           rc{this->injection_head};
+        if (rc == nullptr)
+            return nullptr;
+        // Move a fair share of the queue to the local deque to avoid contention on the mutex.
+        std::size_t count{std::min(injection_batch,
+                                   this->injected.load(std::memory_order_relaxed) / this->workers.size() + 1u)};
+        this->injection_head = rc->next;
+        std::size_t taken{1u};
+        for (; taken != count && this->injection_head; ++taken) {
+            work* next{this->injection_head->next};
+            if (not self.queue.push(this->injection_head))
+                break;
+            this->injection_head = next;
+        }
+        if (this->injection_head == nullptr)
+            this->injection_tail = nullptr;
+        this->injected.fetch_sub(taken, std::memory_order_relaxed);
+        return rc;
+    }
+    auto push_local(worker& self, work* w) noexcept -> void {
+        if (not self.queue.push(w))
+            this->inject(w);
+    }
+    auto steal(worker& self) noexcept -> work* {
+        std::size_t size{this->workers.size()};
+        // xorshift to pick a pseudo-random first victim
+        self.seed ^= self.seed << 13;
+        self.seed ^= self.seed >> 17;
+        self.seed ^= self.seed << 5;
+        std::size_t start{self.seed % size};
+        for (std::size_t i{}; i != size; ++i) {
+            worker& victim{*this->workers[(start + i) % size]};
+            if (&victim != &self)
+                if (work* w{victim.queue.steal()})
+                    return w;
+        }
+        // A worker busy with a long running item shouldn't hold on to its LIFO slot.
+        for (std::size_t i{}; i != size; ++i) {
+            worker& victim{*this->workers[(start + i) % size]};
+            if (&victim != &self && victim.lifo.load(std::memory_order_relaxed))
+                if (work* w{victim.lifo.exchange(nullptr, std::memory_order_acquire)})
+                    return w;
+        }
+        return nullptr;
+    }
+    auto find_work(worker& self) noexcept -> work* {
+        if (++self.tick % injection_interval == 0u)
+            if (work* w{this->take_injected(self)})
+                return w;
+        if (self.lifo_runs < lifo_limit) {
+            if (work* w{self.lifo.exchange(nullptr, std::memory_order_acquire)}) {
+                ++self.lifo_runs;
+                return w;
+            }
+        } else if (work* w{self.lifo.exchange(nullptr, std::memory_order_acquire)}) {
+            // Run the oldest local item instead of the LIFO slot to let older work progress.
+            this->push_local(self, w);
+            self.lifo_runs = 0u;
+            if (work* oldest{self.queue.steal()})
+                return oldest;
+        }
+        self.lifo_runs = 0u;
+        if (work* w{self.queue.pop()})
+            return w;
+        if (work* w{this->take_injected(self)})
+            return w;
+        return this->steal(self);
+    }
+    auto notify() noexcept -> void {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (0u < this->sleepers.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard cerberus(this->mutex);
+                this->epoch.fetch_add(1u, std::memory_order_release);
+            }
+            this->condition.notify_one();
+        }
+    }
+    auto park(worker& self) -> work* {
+        this->sleepers.fetch_add(1u, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t e{this->epoch.load(std::memory_order_acquire)};
+        work*         rc{this->find_work(self)};
+        if (rc == nullptr && not this->stopping.load(std::memory_order_acquire)) {
+            std::unique_lock cerberus(this->mutex);
+            this->condition.wait(cerberus, [this, e] {
+                return this->stopping.load(std::memory_order_relaxed) ||
+                       this->epoch.load(std::memory_order_relaxed) != e;
+            });
+        }
+        this->sleepers.fetch_sub(1u, std::memory_order_relaxed);
+        return rc;
+    }
+    auto run(worker& self) -> void {
+        current() = &self;
+        while (true) {
+            work* w{this->find_work(self)};
+            for (std::size_t i{}; w == nullptr && i != spin_rounds; ++i) {
+                if (this->stopping.load(std::memory_order_acquire))
+                    break;
+                std::this_thread::yield();
+                w = this->find_work(self);
+            }
+            if (w == nullptr && this->stopping.load(std::memory_order_acquire)) {
+                w = this->find_work(self);
+                if (w == nullptr)
+                    break;
+            }
+            if (w == nullptr)
+                w = this->park(self);
+            if (w)
+                w->execute();
+        }
+        current() = nullptr;
+    }
+    auto submit(work* w) noexcept -> void {
+        worker* self{current()};
+        if (self && self->owner == this) {
+            if (work* previous{self->lifo.exchange(w, std::memory_order_acq_rel)})
+                this->push_local(*self, previous);
+        } else {
+            this->inject(w);
+        }
+        this->notify();
+    }
+
+    template <typename Child, typename Env>
+    static auto bulk_context(const Child& child, const Env& env) -> work_stealing_context* {
+        if constexpr (requires {
+                          {
+                              ::beman::execution::get_completion_scheduler<::beman::execution::set_value_t>(
+                                  ::beman::execution::get_env(child))
+                          } -> std::same_as<scheduler>;
+                      })
+            return ::beman::execution::get_completion_scheduler<::beman::execution::set_value_t>(
+                       ::beman::execution::get_env(child))
+                .context;
+        else
+            return scheduler(::beman::execution::get_scheduler(env)).context;
+    }
+
+    template <::beman::execution::receiver Receiver>
+    struct state : work {
+        using operation_state_concept = ::beman::execution::operation_state_tag;
+        work_stealing_context*        context;
+        std::remove_cvref_t<Receiver> receiver;
+
+        template <::beman::execution::receiver R>
+        state(work_stealing_context* c, R&& r) : context(c), receiver(std::forward<R>(r)) {}
+        auto start() & noexcept -> void { this->context->submit(this); }
+        auto execute() noexcept -> void override { ::beman::execution::set_value(std::move(this->receiver)); }
+    };
+
+    template <typename Fun, ::beman::execution::receiver Receiver>
+    struct bulk_state {
+        struct part : work {
+            bulk_state* self{};
+            auto        execute() noexcept -> void override { this->self->process(); }
+        };
+
+        using operation_state_concept = ::beman::execution::operation_state_tag;
+        work_stealing_context*        context;
+        std::remove_cvref_t<Receiver> receiver;
+        Fun                           fun;
+        std::size_t                   shape;
+        std::size_t                   chunks;
+        std::size_t                   count;
+        std::unique_ptr<part[]>       parts;
+        std::atomic<std::size_t>      next{};
+        std::atomic<std::size_t>      remaining;
+        std::atomic<bool>             failed{};
+        std::exception_ptr            error{};
+
+        template <::beman::execution::receiver R>
+        bulk_state(work_stealing_context* c, R&& r, Fun&& f, std::size_t n)
+            : context(c),
+              receiver(std::forward<R>(r)),
+              fun(std::move(f)),
+              shape(n),
+              chunks(::beman::task::detail::chunk_count(n, c->size())),
+              count(std::min(this->chunks, c->size())),
+              parts(new part[this->count]),
+              remaining(this->count) {}
+        auto start() & noexcept -> void {
+            if (this->count == 0u) {
+                ::beman::execution::set_value(std::move(this->receiver));
+                return;
+            }
+            // The last part may complete the operation before submit() returns: don't touch members afterwards.
+            work_stealing_context* ctxt{this->context};
+            part*                  begin{this->parts.get()};
+            part*                  end{begin + this->count};
+            for (part* it{begin}; it != end; ++it)
+                it->self = this;
+            for (part* it{begin}; it != end; ++it)
+                ctxt->submit(it);
+        }
+        auto process() noexcept -> void {
+            for (std::size_t c{}; (c = this->next.fetch_add(1u, std::memory_order_relaxed)) < this->chunks;) {
+                auto [b, e]{::beman::task::detail::chunk_range(c, this->shape, this->chunks)};
+                try {
+                    this->fun(b, e);
+                } catch (...) {
+                    if (not this->failed.exchange(true))
+                        this->error = std::current_exception();
+                }
+            }
+            if (this->remaining.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+                if (this->failed.load())
+                    ::beman::execution::set_error(std::move(this->receiver), std::move(this->error));
+                else
+                    ::beman::execution::set_value(std::move(this->receiver));
+            }
+        }
+    };
+
+  public:
+    class env;
+    class sender {
+        friend class scheduler;
+
+      private:
+        work_stealing_context* context;
+        explicit sender(work_stealing_context* c) noexcept : context(c) {}
+
+      public:
+        using sender_concept        = ::beman::execution::sender_tag;
+        using completion_signatures = ::beman::execution::completion_signatures<::beman::execution::set_value_t()>;
+        template <typename...>
+        static consteval auto get_completion_signatures() noexcept -> completion_signatures {
+            return {};
+        }
+
+        template <::beman::execution::receiver Receiver>
+        auto connect(Receiver&& receiver) const -> state<Receiver> {
+            return state<Receiver>(this->context, std::forward<Receiver>(receiver));
+        }
+        auto get_env() const noexcept -> env;
+    };
+
+    /*!
+     * \brief Sender calling `fun(begin, end)` for chunks of `[0, shape)` on the workers
+     */
+    template <typename Fun>
+    class bulk_sender {
+        friend class work_stealing_context;
+
+      private:
+        work_stealing_context* context;
+        std::size_t            shape;
+        Fun                    fun;
+
+        bulk_sender(work_stealing_context* c, std::size_t n, Fun f) : context(c), shape(n), fun(std::move(f)) {}
+
+      public:
+        using sender_concept        = ::beman::execution::sender_tag;
+        using completion_signatures = ::beman::execution::completion_signatures<
+            ::beman::execution::set_value_t(),
+            ::beman::execution::set_error_t(std::exception_ptr)>;
+        template <typename...>
+        static consteval auto get_completion_signatures() noexcept -> completion_signatures {
+            return {};
+        }
+
+        template <::beman::execution::receiver Receiver>
+        auto connect(Receiver&& receiver) && -> bulk_state<Fun, Receiver> {
+            return bulk_state<Fun, Receiver>(
+                this->context, std::forward<Receiver>(receiver), std::move(this->fun), this->shape);
+        }
+        template <::beman::execution::receiver Receiver>
+            requires ::std::copy_constructible<Fun>
+        auto connect(Receiver&& receiver) const& -> bulk_state<Fun, Receiver> {
+            return bulk_state<Fun, Receiver>(
+                this->context, std::forward<Receiver>(receiver), Fun(this->fun), this->shape);
+        }
+        auto get_env() const noexcept -> env;
+    };
+
+    /*!
+     * \brief Domain transforming `bulk` senders to process chunks in parallel
+     */
+    struct domain {
+        template <::beman::execution::sender Sndr, typename Env>
+            requires ::std::same_as<::beman::execution::tag_of_t<::std::remove_cvref_t<Sndr>>,
+                                    ::beman::execution::bulk_t>
+        auto transform_sender(Sndr&& sndr, const Env& env) const {
+            return ::beman::task::detail::chunked_bulk(::std::forward<Sndr>(sndr), [&env](const auto& child) {
+                return [ctxt = work_stealing_context::bulk_context(child, env)](std::size_t shape, auto body) {
+                    return bulk_sender<decltype(body)>(ctxt, shape, std::move(body));
+                };
+            });
+        }
+    };
+
+    class scheduler {
+        friend class work_stealing_context;
+
+      private:
+        work_stealing_context* context;
+        explicit scheduler(work_stealing_context* c) noexcept : context(c) {}
+
+      public:
+        using scheduler_concept = ::beman::execution::scheduler_tag;
+
+        auto schedule() const noexcept -> sender { return sender(this->context); }
+        auto query(const ::beman::execution::get_domain_t&) const noexcept -> domain { return {}; }
+        auto query(const ::beman::task::detail::parallelism_t&) const noexcept -> std::size_t {
+            return this->context->size();
+        }
+        auto operator==(const scheduler&) const noexcept -> bool = default;
+    };
+
+    class env {
+        friend class sender;
+        template <typename>
+        friend class bulk_sender;
+
+      private:
+        work_stealing_context* context;
+        explicit env(work_stealing_context* c) noexcept : context(c) {}
+
+      public:
+        auto query(const ::beman::execution::get_completion_scheduler_t<::beman::execution::set_value_t>&)
+            const noexcept -> scheduler {
+            return scheduler(this->context);
+        }
+    };
+
+    explicit work_stealing_context(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        threads = std::max(std::size_t(1u), threads);
+        this->workers.reserve(threads);
+        for (std::size_t i{}; i != threads; ++i)
+            this->workers.push_back(
+                std::unique_ptr<worker>(new worker{this, std::uint32_t(2654435761u * (i + 1u))}));
+        try {
+            for (auto& w : this->workers)
+                w->thread = std::thread([this, &self = *w] { this->run(self); });
+        } catch (...) {
+            this->finish();
+            for (auto& w : this->workers)
+                if (w->thread.joinable())
+                    w->thread.join();
+            throw;
+        }
+    }
+    work_stealing_context(work_stealing_context&&)                 = delete;
+    work_stealing_context(const work_stealing_context&)            = delete;
+    work_stealing_context& operator=(work_stealing_context&&)      = delete;
+    work_stealing_context& operator=(const work_stealing_context&) = delete;
+    ~work_stealing_context() {
+        this->finish();
+        for (auto& w : this->workers)
+            w->thread.join();
+    }
+
+    auto get_scheduler() noexcept -> scheduler { return scheduler(this); }
+    auto size() const noexcept -> std::size_t { return this->workers.size(); }
+    /*!
+     * \brief Let the workers exit once there is no more work.
+     */
+    auto finish() -> void {
+        {
+            std::lock_guard cerberus(this->mutex);
+            this->stopping.store(true, std::memory_order_release);
+            this->epoch.fetch_add(1u, std::memory_order_relaxed);
+        }
+        this->condition.notify_all();
+    }
+};
+
+inline auto work_stealing_context::sender::get_env() const noexcept -> env { return env(this->context); }
+template <typename Fun>
+inline auto work_stealing_context::bulk_sender<Fun>::get_env() const noexcept -> env {
+    return env(this->context);
+}
+} // namespace beman::task::detail
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -6,11 +6,22 @@
 
 #include <beman/execution.hpp>
 #include <beman/task/detail/allocator_of.hpp>
+#include <beman/task/detail/as_expected.hpp>
+#include <beman/task/detail/async_stack.hpp>
+#include <beman/task/detail/can_run_inline.hpp>
+#include <beman/task/detail/frame_arena.hpp>
+#include <beman/task/detail/frame_pool.hpp>
+#include <beman/task/detail/frame_stats.hpp>
 #include <beman/task/detail/task_scheduler.hpp>
 #include <beman/task/detail/into_optional.hpp>
+#include <beman/task/detail/noexcept_environment.hpp>
+#include <beman/task/detail/numa_context.hpp>
 #include <beman/task/detail/task.hpp>
 #include <beman/task/detail/scheduler_of.hpp>
 #include <beman/task/detail/stop_source.hpp>
+#include <beman/task/detail/thread_pool_context.hpp>
+#include <beman/task/detail/trace.hpp>
+#include <beman/task/detail/work_stealing_context.hpp>
 
 // ----------------------------------------------------------------------------
 
@@ -25,8 +36,33 @@ using stop_source_of_t = ::beman::task::detail::stop_source_of_t<Context>;
 using task_scheduler   = ::beman::task::detail::task_scheduler;
 using inline_scheduler = ::beman::execution::inline_scheduler;
 using into_optional_t  = ::beman::task::detail::into_optional_t;
+using as_expected_t    = ::beman::task::detail::as_expected_t;
+using can_run_inline_t = ::beman::task::detail::can_run_inline_t;
+using run_loop_scope   = ::beman::task::detail::run_loop_scope;
+using ::beman::task::detail::as_expected;
+using ::beman::task::detail::can_run_inline;
 using ::beman::task::detail::into_optional;
 
+using noexcept_environment = ::beman::task::detail::noexcept_environment;
+
+using frame_arena = ::beman::task::detail::frame_arena;
+using frame_pool  = ::beman::task::detail::frame_pool;
+using frame_stats = ::beman::task::detail::frame_stats;
+template <typename T = ::std::byte>
+using frame_arena_allocator = ::beman::task::detail::frame_arena_allocator<T>;
+template <typename T = ::std::byte>
+using frame_pool_allocator = ::beman::task::detail::frame_pool_allocator<T>;
+template <typename T = ::std::byte>
+using numa_frame_allocator = ::beman::task::detail::numa_frame_allocator<T>;
+
+using numa_context          = ::beman::task::detail::numa_context;
+using thread_pool_context   = ::beman::task::detail::thread_pool_context;
+using work_stealing_context = ::beman::task::detail::work_stealing_context;
+
+using trace       = ::beman::task::detail::trace;
+using trace_event = ::beman::task::detail::trace_event;
+using async_stack = ::beman::task::detail::async_stack;
+
 using ::beman::task::detail::change_coroutine_scheduler;
 using ::beman::task::detail::with_error;
 } // namespace beman::task
@@ -41,8 +77,12 @@ using stop_source_of_t = ::beman::task::detail::stop_source_of_t<Context>;
 
 using task_scheduler  = ::beman::task::detail::task_scheduler;
 using into_optional_t = ::beman::task::detail::into_optional_t;
+using as_expected_t   = ::beman::task::detail::as_expected_t;
+using ::beman::task::detail::as_expected;
 using ::beman::task::detail::into_optional;
 
+using noexcept_environment = ::beman::task::detail::noexcept_environment;
+
 using ::beman::task::detail::change_coroutine_scheduler;
 using ::beman::task::detail::with_error;
 template <typename T = void, typename Context = ::beman::task::detail::default_environment>
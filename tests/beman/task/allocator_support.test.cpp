@@ -47,12 +47,15 @@ struct allocator_aware : some_data, beman::task::detail::allocator_support<Alloc
 
 int main() {
     using type = allocator_aware<std::pmr::polymorphic_allocator<std::byte>>;
-    [[maybe_unused]] std::unique_ptr<type> unused(new type{});
+    std::unique_ptr<type> unused(new type{});
+    // without an allocator argument the allocator is default constructed
+    assert(type::get_frame_allocator(unused.get()) == nullptr);
 
     test_resource resource{};
     assert(resource.outstanding == 0u);
     type* ptr{new (std::allocator_arg, &resource) type{}};
     assert(resource.outstanding != 0u);
+    assert(type::get_frame_allocator(ptr)->resource() == &resource);
     ptr->~type();
     assert(resource.outstanding != 0u);
 #ifdef __GNUC__
@@ -0,0 +1,129 @@
+// tests/beman/task/as_expected.test.cpp                              -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/as_expected.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <concepts>
+#include <exception>
+#include <expected>
+#include <stdexcept>
+#include <variant>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+template <typename... E>
+struct error_env {
+    using error_types = ex::completion_signatures<ex::set_error_t(E)...>;
+};
+
+static_assert(std::same_as<bt::expected_of_t<int, bt::error_types_of_t<bt::default_environment>>,
+                           std::expected<int, std::exception_ptr>>);
+static_assert(std::same_as<bt::expected_of_t<void, bt::error_types_of_t<error_env<int>>>, std::expected<void, int>>);
+static_assert(std::same_as<bt::expected_of_t<int, bt::error_types_of_t<error_env<int, bool>>>,
+                           std::expected<int, std::variant<int, bool>>>);
+static_assert(std::same_as<bt::expected_of_t<int, bt::error_types_of_t<bt::noexcept_environment>>,
+                           std::expected<int, std::monostate>>);
+
+auto value_task(int value) -> ex::task<int, error_env<int>> { co_return value; }
+auto error_task(int error) -> ex::task<int, error_env<int>> {
+    co_yield ex::with_error(error);
+    co_return 0;
+}
+auto void_task(bool fail) -> ex::task<void, error_env<int, bool>> {
+    if (fail)
+        co_yield ex::with_error(true);
+    co_return;
+}
+auto noexcept_task(int value) -> ex::task<int, ex::noexcept_environment> { co_return value; }
+auto throwing_task() -> ex::task<int> {
+    throw std::runtime_error("failed");
+    co_return 0;
+}
+
+auto test_value() -> void {
+    ex::sync_wait([]() -> ex::task<> {
+        auto e{co_await ex::as_expected(value_task(17))};
+        static_assert(std::same_as<decltype(e), std::expected<int, int>>);
+        assert(e.has_value());
+        assert(*e == 17);
+    }());
+}
+
+auto test_error() -> void {
+    ex::sync_wait([]() -> ex::task<> {
+        auto e{co_await ex::as_expected(error_task(17))};
+        assert(not e.has_value());
+        assert(e.error() == 17);
+
+        auto v{co_await ex::as_expected(void_task(false))};
+        assert(v.has_value());
+        auto f{co_await ex::as_expected(void_task(true))};
+        assert(not f.has_value());
+        assert(std::holds_alternative<bool>(f.error()));
+    }());
+}
+
+auto test_exception() -> void {
+    ex::sync_wait([]() -> ex::task<> {
+        auto e{co_await ex::as_expected(throwing_task())};
+        assert(not e.has_value());
+        try {
+            std::rethrow_exception(e.error());
+        } catch (const std::runtime_error&) {
+        }
+    }());
+}
+
+auto test_stopped() -> void {
+    bool stopped{};
+    ex::sync_wait(
+        []() -> ex::task<> {
+            co_await ex::as_expected([]() -> ex::task<int> {
+                co_await ex::just_stopped();
+                co_return 0;
+            }());
+            assert(nullptr == "a stopped task doesn't resume the awaiting task");
+        }() |
+        ex::upon_stopped([&stopped] { stopped = true; }));
+    assert(stopped);
+}
+
+auto test_noexcept() -> void {
+    ex::sync_wait([]() -> ex::task<> {
+        auto e{co_await ex::as_expected(noexcept_task(17))};
+        static_assert(std::same_as<decltype(e), std::expected<int, std::monostate>>);
+        assert(e.has_value());
+        assert(*e == 17);
+    }());
+    auto v{ex::sync_wait(ex::as_expected(noexcept_task(17)))};
+    assert(v);
+    assert(std::get<0>(*v) == std::expected<int, std::monostate>(17));
+}
+
+auto test_sender() -> void {
+    auto v{ex::sync_wait(ex::as_expected(value_task(17)))};
+    assert(v);
+    assert(std::get<0>(*v) == std::expected<int, int>(17));
+    auto e{ex::sync_wait(ex::as_expected(error_task(17)))};
+    assert(e);
+    assert(std::get<0>(*e).error() == 17);
+}
+} // namespace
+
+int main() {
+    test_value();
+    test_error();
+    test_exception();
+    test_stopped();
+    test_noexcept();
+    test_sender();
+}
@@ -0,0 +1,110 @@
+// tests/beman/task/async_stack.test.cpp                              -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#define BEMAN_TASK_ASYNC_STACK
+#include <beman/task/detail/async_stack.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <source_location>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct env {
+    auto query(const ex::get_scheduler_t&) const noexcept -> ex::inline_scheduler { return {}; }
+};
+
+struct receiver {
+    using receiver_concept = ex::receiver_tag;
+    bool* done;
+
+    auto get_env() const noexcept -> env { return {}; }
+    auto set_value() && noexcept -> void { *this->done = true; }
+    auto set_error(std::exception_ptr) && noexcept -> void {}
+    auto set_stopped() && noexcept -> void {}
+};
+
+std::uint32_t inner_line{};
+
+auto inner(ex::run_loop& loop) -> ex::task<> {
+    inner_line = std::source_location::current().line() + 1u;
+    co_await ex::schedule(loop.get_scheduler());
+}
+auto middle(ex::run_loop& loop) -> ex::task<> { co_await inner(loop); }
+auto outer(ex::run_loop& loop) -> ex::task<> { co_await middle(loop); }
+
+auto find(const std::vector<bt::async_stack::frame>& frames, const void* task) -> const bt::async_stack::frame* {
+    for (const auto& f : frames)
+        if (f.task == task)
+            return &f;
+    return nullptr;
+}
+
+auto test_chain() -> void {
+    ex::run_loop loop;
+    bool         done{};
+    auto         state{ex::connect(outer(loop), receiver{&done})};
+    assert(bt::async_stack::snapshot().size() == 1u);
+    ex::start(state);
+    assert(not done);
+
+    const std::vector<bt::async_stack::frame> frames{bt::async_stack::snapshot()};
+    assert(frames.size() == 3u);
+    std::size_t roots{};
+    for (const auto& f : frames) {
+        roots += f.parent == nullptr;
+        assert(f.parent == nullptr || find(frames, f.parent));
+        assert(f.file && std::string_view(f.file) == std::source_location::current().file_name());
+    }
+    assert(roots == 1u);
+
+    const bt::async_stack::frame* innermost{};
+    for (const auto& f : frames) {
+        bool is_parent{};
+        for (const auto& o : frames)
+            is_parent = is_parent || o.parent == f.task;
+        if (not is_parent)
+            innermost = &f;
+    }
+    assert(innermost);
+    assert(innermost->suspended);
+    assert(innermost->line == inner_line);
+    assert(innermost->parent && find(frames, innermost->parent)->parent);
+
+    std::ostringstream out;
+    bt::async_stack::dump(out);
+    assert(out.str().find("suspended at") != std::string::npos);
+    assert(out.str().find("awaited by") != std::string::npos);
+
+    char              buffer[4096];
+    const std::size_t size{bt::async_stack::dump(buffer, sizeof(buffer))};
+    assert(0u < size && size < sizeof(buffer));
+    assert(std::string_view(buffer, size).find(std::source_location::current().file_name()) != std::string::npos);
+    assert(bt::async_stack::dump(buffer, 10u) == 10u);
+
+    loop.finish();
+    loop.run();
+    assert(done);
+}
+} // namespace
+
+int main() {
+    assert(bt::async_stack::enabled);
+    assert(bt::async_stack::snapshot().empty());
+    test_chain();
+    assert(bt::async_stack::snapshot().empty());
+}
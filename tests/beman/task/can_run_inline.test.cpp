@@ -0,0 +1,101 @@
+// tests/beman/task/can_run_inline.test.cpp                           -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#define BEMAN_TASK_TRACE
+#include <beman/task/detail/can_run_inline.hpp>
+#include <beman/task/detail/single_thread_context.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct custom_scheduler : ex::inline_scheduler {
+    bool answer{};
+    auto query(const bt::can_run_inline_t&) const noexcept -> bool { return this->answer; }
+    auto operator==(const custom_scheduler&) const -> bool = default;
+};
+
+auto count_reschedules() -> std::size_t {
+    std::size_t rc{};
+    for (const auto& t : bt::trace::collect())
+        rc += std::size_t(std::ranges::count(t.records, bt::trace_event::reschedule, &bt::trace::record::event));
+    return rc;
+}
+
+auto test_query() -> void {
+    assert(bt::can_run_inline(ex::inline_scheduler{}));
+    assert(bt::can_run_inline(custom_scheduler{{}, true}));
+    assert(not bt::can_run_inline(custom_scheduler{{}, false}));
+    assert(bt::can_run_inline(ex::task_scheduler(ex::inline_scheduler{})));
+
+    ex::run_loop loop;
+    ex::run_loop other;
+    assert(not bt::can_run_inline(loop.get_scheduler()));
+    {
+        bt::run_loop_scope scope(loop);
+        assert(bt::run_loop_scope::get() == &loop);
+        assert(bt::can_run_inline(loop.get_scheduler()));
+        assert(bt::can_run_inline(ex::task_scheduler(loop.get_scheduler())));
+        assert(not bt::can_run_inline(other.get_scheduler()));
+        {
+            bt::run_loop_scope nested(other);
+            assert(not bt::can_run_inline(loop.get_scheduler()));
+            assert(bt::can_run_inline(other.get_scheduler()));
+        }
+        assert(bt::can_run_inline(loop.get_scheduler()));
+    }
+    assert(not bt::can_run_inline(loop.get_scheduler()));
+}
+
+auto test_single_thread_context() -> void {
+    bt::single_thread_context context;
+    assert(not bt::can_run_inline(context.get_scheduler()));
+    auto [inside]{ex::sync_wait(ex::schedule(context.get_scheduler()) |
+                                ex::then([&context] { return bt::can_run_inline(context.get_scheduler()); }))
+                      .value_or(std::tuple(false))};
+    assert(inside);
+}
+
+auto switch_to_inline() -> ex::task<> { co_await ex::change_coroutine_scheduler(ex::inline_scheduler{}); }
+auto switch_to(bt::single_thread_context& ctx) -> ex::task<> {
+    co_await ex::change_coroutine_scheduler(ex::task_scheduler(ctx.get_scheduler()));
+}
+auto await_on_same_thread(ex::task<> child) -> ex::task<> {
+    const auto id{std::this_thread::get_id()};
+    co_await std::move(child);
+    assert(id == std::this_thread::get_id());
+}
+
+auto test_elision() -> void {
+    bt::single_thread_context context;
+    bt::single_thread_context other;
+
+    // The child ends up on the inline_scheduler while running on the parent's thread.
+    bt::trace::clear();
+    ex::sync_wait(ex::starts_on(context.get_scheduler(), await_on_same_thread(switch_to_inline())));
+    assert(count_reschedules() == 0u);
+
+    // The child completes on a different thread: the parent needs to be rescheduled.
+    bt::trace::clear();
+    ex::sync_wait(ex::starts_on(context.get_scheduler(), await_on_same_thread(switch_to(other))));
+    assert(count_reschedules() == 1u);
+}
+} // namespace
+
+int main() {
+    test_query();
+    test_single_thread_context();
+    test_elision();
+}
@@ -0,0 +1,92 @@
+// tests/beman/task/current_allocator.test.cpp                        -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/current_allocator.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <tuple>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct resource {
+    std::size_t allocations{};
+};
+
+template <typename T = std::byte>
+struct counting_allocator {
+    using value_type = T;
+    resource* res{};
+
+    counting_allocator() = default;
+    explicit counting_allocator(resource* r) noexcept : res(r) {}
+    template <typename U>
+    counting_allocator(const counting_allocator<U>& other) noexcept : res(other.res) {}
+
+    auto allocate(std::size_t n) -> T* {
+        if (this->res)
+            ++this->res->allocations;
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    auto deallocate(T* ptr, std::size_t n) noexcept -> void { ::operator delete(ptr, n * sizeof(T)); }
+    template <typename U>
+    auto operator==(const counting_allocator<U>& other) const noexcept -> bool {
+        return this->res == other.res;
+    }
+};
+
+struct counting_env {
+    using allocator_type = counting_allocator<>;
+};
+
+void test_find_frame_allocator() {
+    resource r0, r1;
+    assert(bt::find_frame_allocator<counting_allocator<>>(17).res == nullptr);
+    counting_allocator<> a0(&r0);
+    bt::current_allocator<counting_allocator<>>::set(&a0);
+    assert(bt::find_frame_allocator<counting_allocator<>>(17).res == &r0);
+    assert(bt::find_frame_allocator<counting_allocator<>>(std::allocator_arg, counting_allocator<>(&r1)).res == &r1);
+    bt::current_allocator<counting_allocator<>>::set(nullptr);
+    assert(bt::find_frame_allocator<counting_allocator<>>(17).res == nullptr);
+}
+
+auto leaf(int value) -> ex::task<int, counting_env> {
+    auto alloc{co_await ex::read_env(ex::get_allocator)};
+    assert(alloc.res != nullptr);
+    co_return value;
+}
+auto inner(int value) -> ex::task<int, counting_env> {
+    int result{co_await leaf(value)};
+    co_await ex::just();
+    co_return result + co_await leaf(value);
+}
+auto outer(std::allocator_arg_t, counting_allocator<>, int value) -> ex::task<int, counting_env> {
+    co_return co_await inner(value);
+}
+
+void test_task_tree() {
+    resource r;
+    auto [value]{ex::sync_wait(outer(std::allocator_arg, counting_allocator<>(&r), 17)).value_or(std::tuple(0))};
+    assert(value == 34);
+    assert(r.allocations == 4u);
+    // Once no task runs anymore, frames aren't allocated using the allocator.
+    assert(bt::current_allocator<counting_allocator<>>::get() == nullptr);
+    auto t{inner(17)};
+    assert(r.allocations == 4u);
+}
+} // namespace
+
+int main() {
+    test_find_frame_allocator();
+    test_task_tree();
+}
@@ -0,0 +1,24 @@
+// tests/beman/task/eager_start_of.test.cpp                           -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/eager_start_of.hpp>
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct default_environment {};
+template <bool Value>
+struct eager_context {
+    static constexpr bool eager_start{Value};
+};
+struct non_static_context {
+    bool eager_start{true};
+};
+} // namespace
+
+int main() {
+    static_assert(not beman::task::detail::eager_start_of_v<default_environment>);
+    static_assert(beman::task::detail::eager_start_of_v<eager_context<true>>);
+    static_assert(not beman::task::detail::eager_start_of_v<eager_context<false>>);
+    static_assert(not beman::task::detail::eager_start_of_v<non_static_context>);
+}
@@ -0,0 +1,120 @@
+// tests/beman/task/frame_arena.test.cpp                              -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/frame_arena.hpp>
+#include <beman/task/detail/allocator_support.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4291)
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct frame {
+    char data[100]{};
+};
+
+struct arena_frame : frame, bt::allocator_support<bt::frame_arena_allocator<>> {};
+
+struct arena_env {
+    using allocator_type = bt::frame_arena_allocator<>;
+};
+
+void test_bump() {
+    bt::frame_arena arena(1024u);
+    void*           p0{arena.allocate(100u)};
+    void*           p1{arena.allocate(1u)};
+    assert(static_cast<std::byte*>(p1) - static_cast<std::byte*>(p0) == 112);
+    assert(reinterpret_cast<std::uintptr_t>(p1) % bt::frame_arena::alignment == 0u);
+    arena.deallocate(p0, 100u);
+    assert(arena.get_stats().allocations == 2u);
+    assert(arena.get_stats().chunks == 1u);
+
+    // a big allocation gets its own chunk
+    void* p2{arena.allocate(4096u)};
+    assert(p2 != nullptr);
+    assert(arena.get_stats().chunks == 2u);
+
+    // resetting keeps the most recent chunk and reuses it
+    arena.reset();
+    assert(arena.get_stats().chunks == 1u);
+    assert(arena.get_stats().allocations == 0u);
+    assert(arena.allocate(100u) == p2);
+}
+
+void test_allocator_support() {
+    static_assert(not bt::allocator_support<bt::frame_arena_allocator<>>::stateless);
+    static_assert(sizeof(bt::frame_arena_allocator<>) == sizeof(void*));
+    bt::frame_arena arena;
+
+    arena_frame* f0{new (std::allocator_arg, bt::frame_arena_allocator<>(arena)) arena_frame{}};
+    arena_frame* f1{new (std::allocator_arg, bt::frame_arena_allocator<>(arena)) arena_frame{}};
+    assert(arena.get_stats().allocations == 2u);
+    delete f0;
+    delete f1;
+    assert(arena.get_stats().allocations == 2u);
+
+    // without an arena the global heap is used
+    arena_frame* f2{new arena_frame{}};
+    delete f2;
+    assert(arena.get_stats().allocations == 2u);
+}
+
+auto child() -> ex::task<int, arena_env> { co_return 17; }
+
+auto parent(std::allocator_arg_t, bt::frame_arena_allocator<>) -> ex::task<int, arena_env> {
+    auto alloc{co_await ex::read_env(ex::get_allocator)};
+    assert(alloc.arena != nullptr);
+    co_return co_await [](std::allocator_arg_t, bt::frame_arena_allocator<>) -> ex::task<int, arena_env> {
+        co_return co_await child();
+    }(std::allocator_arg, alloc);
+}
+
+void test_task() {
+    bt::frame_arena arena;
+    auto [value]{ex::sync_wait(parent(std::allocator_arg, arena)).value_or(std::tuple(0))};
+    assert(value == 17);
+    // child() doesn't get an allocator argument but uses the running task's allocator
+    assert(arena.get_stats().allocations == 3u);
+    arena.reset();
+}
+
+auto nested(std::allocator_arg_t, bt::frame_arena_allocator<>) -> ex::task<int, arena_env> {
+    // sync_wait() runs another task on this thread while this task runs
+    auto [value]{ex::sync_wait(child()).value_or(std::tuple(0))};
+    co_return value + co_await child();
+}
+
+void test_nested_sync_wait() {
+    bt::frame_arena arena;
+    auto [value]{ex::sync_wait(nested(std::allocator_arg, arena)).value_or(std::tuple(0))};
+    assert(value == 34);
+    // the child created after sync_wait() returned still uses the arena
+    assert(arena.get_stats().allocations == 3u);
+    arena.reset();
+}
+} // namespace
+
+int main() {
+    test_bump();
+    test_allocator_support();
+    test_task();
+    test_nested_sync_wait();
+}
@@ -0,0 +1,117 @@
+// tests/beman/task/frame_pool.test.cpp                               -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/frame_pool.hpp>
+#include <beman/task/detail/allocator_support.hpp>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4291)
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct frame {
+    char data[100]{};
+};
+
+struct pooled_frame : frame, bt::allocator_support<bt::frame_pool_allocator<>> {};
+
+void test_recycling() {
+    bt::frame_pool::trim();
+    bt::frame_pool::reset_stats();
+
+    void* p0{bt::frame_pool::allocate(100u)};
+    assert(bt::frame_pool::get_stats().misses == 1u);
+    assert(bt::frame_pool::get_stats().hits == 0u);
+    bt::frame_pool::deallocate(p0, 100u);
+    assert(bt::frame_pool::get_stats().recycled == 1u);
+
+    // same size class: the frame is reused
+    void* p1{bt::frame_pool::allocate(120u)};
+    assert(p1 == p0);
+    assert(bt::frame_pool::get_stats().hits == 1u);
+
+    // different size class: the frame isn't reused
+    void* p2{bt::frame_pool::allocate(200u)};
+    assert(p2 != p0);
+    assert(bt::frame_pool::get_stats().misses == 2u);
+
+    bt::frame_pool::deallocate(p1, 120u);
+    bt::frame_pool::deallocate(p2, 200u);
+    assert(bt::frame_pool::get_stats().recycled == 3u);
+    bt::frame_pool::trim();
+}
+
+void test_oversized() {
+    bt::frame_pool::reset_stats();
+    void* p{bt::frame_pool::allocate(bt::frame_pool::max_size + 1u)};
+    assert(bt::frame_pool::get_stats().misses == 1u);
+    bt::frame_pool::deallocate(p, bt::frame_pool::max_size + 1u);
+    assert(bt::frame_pool::get_stats().released == 1u);
+    assert(bt::frame_pool::get_stats().recycled == 0u);
+}
+
+void test_limit() {
+    bt::frame_pool::trim();
+    bt::frame_pool::reset_stats();
+    void* frames[bt::frame_pool::max_cached + 1u]{};
+    for (auto& f : frames)
+        f = bt::frame_pool::allocate(64u);
+    for (auto& f : frames)
+        bt::frame_pool::deallocate(f, 64u);
+    assert(bt::frame_pool::get_stats().recycled == bt::frame_pool::max_cached);
+    assert(bt::frame_pool::get_stats().released == 1u);
+    bt::frame_pool::trim();
+}
+
+void test_per_thread() {
+    bt::frame_pool::trim();
+    void* p{bt::frame_pool::allocate(64u)};
+    std::thread([p] {
+        bt::frame_pool::reset_stats();
+        bt::frame_pool::deallocate(p, 64u);
+        assert(bt::frame_pool::get_stats().recycled == 1u);
+        assert(bt::frame_pool::allocate(64u) == p);
+        assert(bt::frame_pool::get_stats().hits == 1u);
+        bt::frame_pool::deallocate(p, 64u);
+    }).join();
+}
+
+void test_allocator_support() {
+    static_assert(bt::allocator_support<bt::frame_pool_allocator<>>::stateless);
+    static_assert(bt::allocator_support<std::allocator<std::byte>>::stateless);
+    bt::frame_pool::trim();
+    bt::frame_pool::reset_stats();
+
+    pooled_frame* f0{new pooled_frame{}};
+    delete f0;
+    pooled_frame* f1{new pooled_frame{}};
+    assert(static_cast<void*>(f0) == static_cast<void*>(f1));
+    delete f1;
+    assert(bt::frame_pool::get_stats().misses == 1u);
+    assert(bt::frame_pool::get_stats().hits == 1u);
+    assert(bt::frame_pool::get_stats().recycled == 2u);
+    bt::frame_pool::trim();
+}
+} // namespace
+
+int main() {
+    test_recycling();
+    test_oversized();
+    test_limit();
+    test_per_thread();
+    test_allocator_support();
+}
@@ -0,0 +1,73 @@
+// tests/beman/task/frame_stats.test.cpp                              -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#define BEMAN_TASK_FRAME_STATS
+#include <beman/task/detail/frame_stats.hpp>
+#include <beman/task/detail/allocator_support.hpp>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4291)
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+template <std::size_t Size>
+struct frame {
+    char data[Size]{};
+};
+
+struct small_frame : frame<24>, bt::allocator_support<std::allocator<std::byte>, small_frame> {};
+struct large_frame : frame<1000>, bt::allocator_support<std::allocator<std::byte>, large_frame> {};
+
+auto find(std::size_t size) -> bt::frame_stats::entry {
+    for (const auto& e : bt::frame_stats::get_stats())
+        if (e.size == size)
+            return e;
+    return {};
+}
+} // namespace
+
+int main() {
+    static_assert(bt::frame_stats::enabled);
+    bt::frame_stats::reset_stats();
+
+    {
+        auto s0{std::make_unique<small_frame>()};
+        auto s1{std::make_unique<small_frame>()};
+        auto l0{std::make_unique<large_frame>()};
+        assert(find(sizeof(small_frame)).allocations == 2u);
+        assert(find(sizeof(small_frame)).live == 2u);
+        assert(find(sizeof(large_frame)).allocations == 1u);
+        assert(find(sizeof(large_frame)).owner.find("large_frame") != std::string_view::npos);
+        assert(bt::frame_stats::get_totals().live == 3u);
+        assert(bt::frame_stats::get_totals().bytes == 2u * sizeof(small_frame) + sizeof(large_frame));
+    }
+    assert(find(sizeof(small_frame)).live == 0u);
+    assert(find(sizeof(small_frame)).peak_live == 2u);
+    assert(bt::frame_stats::get_totals().live == 0u);
+    assert(bt::frame_stats::get_totals().peak_live == 3u);
+    assert(bt::frame_stats::get_stats().front().size == sizeof(large_frame));
+
+    std::ostringstream out;
+    bt::frame_stats::dump(out);
+    assert(out.str().find("peak_live=3") != std::string::npos);
+    assert(out.str().find("<=1024") != std::string::npos);
+
+    bt::frame_stats::reset_stats();
+    assert(bt::frame_stats::get_stats().empty());
+    assert(bt::frame_stats::get_totals().allocations == 0u);
+}
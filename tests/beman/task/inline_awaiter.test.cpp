@@ -0,0 +1,100 @@
+// tests/beman/task/inline_awaiter.test.cpp                           -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/inline_awaiter.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <coroutine>
+#include <string>
+#include <tuple>
+#include <utility>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct env {
+    auto query(const ex::get_stop_token_t&) const noexcept -> ex::never_stop_token { return {}; }
+};
+struct promise {
+    auto get_env() const noexcept -> env { return {}; }
+    auto unhandled_stopped() noexcept -> std::coroutine_handle<> { return std::noop_coroutine(); }
+};
+
+template <typename Sender>
+using awaiter = bt::inline_awaiter<Sender, promise>;
+
+auto test_inline_senders() -> void {
+    static_assert(bt::inline_sender<decltype(ex::just()), env>);
+    static_assert(bt::inline_sender<decltype(ex::just(1, 2)), env>);
+    static_assert(bt::inline_sender<decltype(ex::just_error(17)), env>);
+    static_assert(bt::inline_sender<decltype(ex::just_stopped()), env>);
+    static_assert(bt::inline_sender<decltype(ex::read_env(ex::get_stop_token)), env>);
+    static_assert(not bt::inline_sender<decltype(ex::schedule(ex::inline_scheduler{})), env>);
+    static_assert(not bt::inline_sender<decltype(ex::just() | ex::then([] {})), env>);
+    ex::run_loop loop;
+    static_assert(not bt::inline_sender<decltype(ex::schedule(loop.get_scheduler())), env>);
+}
+
+auto test_awaiter() -> void {
+    promise p;
+    {
+        awaiter<decltype(ex::just(17))> aw(ex::just(17), p);
+        assert(aw.await_ready());
+        assert(aw.await_resume() == 17);
+    }
+    {
+        awaiter<decltype(ex::just(17, std::string("x")))> aw(ex::just(17, std::string("x")), p);
+        assert(aw.await_ready());
+        assert(aw.await_resume() == std::tuple(17, std::string("x")));
+    }
+    {
+        awaiter<decltype(ex::read_env(ex::get_stop_token))> aw(ex::read_env(ex::get_stop_token), p);
+        assert(aw.await_ready());
+        assert(not aw.await_resume().stop_possible());
+    }
+    {
+        awaiter<decltype(ex::just_error(17))> aw(ex::just_error(17), p);
+        assert(aw.await_ready());
+        try {
+            aw.await_resume();
+            assert(false);
+        } catch (int error) {
+            assert(error == 17);
+        }
+    }
+    {
+        awaiter<decltype(ex::just_stopped())> aw(ex::just_stopped(), p);
+        assert(not aw.await_ready());
+    }
+}
+
+auto test_task() -> void {
+    auto [value]{ex::sync_wait([]() -> ex::task<int> {
+                     int sum{co_await ex::just(1)};
+                     auto [a, b]{co_await ex::just(2, 3)};
+                     co_await ex::schedule(ex::inline_scheduler{});
+                     try {
+                         co_await ex::just_error(4);
+                     } catch (int e) {
+                         sum += e;
+                     }
+                     co_return sum + a + b;
+                 }())
+                     .value_or(std::tuple(0))};
+    assert(value == 10);
+    assert(not ex::sync_wait([]() -> ex::task<> { co_await ex::just_stopped(); }()));
+}
+} // namespace
+
+int main() {
+    test_inline_senders();
+    test_awaiter();
+    test_task();
+}
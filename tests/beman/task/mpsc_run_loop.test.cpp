@@ -0,0 +1,106 @@
+// tests/beman/task/mpsc_run_loop.test.cpp                            -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/mpsc_run_loop.hpp>
+#include <beman/task/detail/infallible_scheduler.hpp>
+#include <beman/task/detail/single_thread_context.hpp>
+#include <beman/task/detail/task_scheduler.hpp>
+#include <beman/execution/execution.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <thread>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+static_assert(ex::scheduler<bt::mpsc_run_loop::scheduler>);
+static_assert(bt::infallible_scheduler<bt::mpsc_run_loop::scheduler, ex::env<>>);
+
+struct receiver {
+    using receiver_concept = ex::receiver_tag;
+    bt::mpsc_run_loop*        loop;
+    std::atomic<std::size_t>* count;
+    std::size_t*              last;
+    std::size_t               index;
+    auto                      set_value() && noexcept -> void {
+        assert(bt::can_run_inline(this->loop->get_scheduler()));
+        if (this->last) {
+            assert(*this->last == this->index);
+            ++*this->last;
+        }
+        ++*this->count;
+    }
+};
+
+struct item {
+    decltype(ex::connect(ex::schedule(std::declval<bt::mpsc_run_loop::scheduler>()), std::declval<receiver>())) state;
+    item(bt::mpsc_run_loop& loop, receiver r) : state(ex::connect(ex::schedule(loop.get_scheduler()), std::move(r))) {}
+};
+
+auto test_order() -> void {
+    bt::mpsc_run_loop        loop;
+    std::atomic<std::size_t> count{};
+    std::size_t              last{};
+    std::deque<item>         items;
+    for (std::size_t i{}; i != 100u; ++i)
+        items.emplace_back(loop, receiver{&loop, &count, &last, i});
+    for (auto& i : items)
+        ex::start(i.state);
+    assert(count == 0u);
+    assert(not bt::can_run_inline(loop.get_scheduler()));
+    loop.finish();
+    loop.run();
+    assert(count == 100u);
+    assert(last == 100u);
+}
+
+auto test_producers() -> void {
+    constexpr std::size_t    producers{4u};
+    constexpr std::size_t    per_producer{10000u};
+    bt::mpsc_run_loop        loop;
+    std::atomic<std::size_t> count{};
+    std::thread              consumer([&loop] { loop.run(); });
+
+    std::vector<std::deque<item>> items(producers);
+    std::vector<std::thread>      threads;
+    for (std::size_t p{}; p != producers; ++p)
+        threads.emplace_back([&loop, &count, &list = items[p]] {
+            for (std::size_t i{}; i != per_producer; ++i) {
+                list.emplace_back(loop, receiver{&loop, &count, nullptr, i});
+                ex::start(list.back().state);
+                if (i % 1000u == 0u)
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+    loop.finish();
+    consumer.join();
+    assert(count == producers * per_producer);
+}
+
+auto test_task_scheduler() -> void {
+    bt::mpsc_single_thread_context context;
+    auto [same]{ex::sync_wait(ex::schedule(bt::task_scheduler(context.get_scheduler())) | ex::then([&context] {
+                                  return bt::can_run_inline(bt::task_scheduler(context.get_scheduler()));
+                              }))
+                    .value_or(std::tuple(false))};
+    assert(same);
+}
+} // namespace
+
+int main() {
+    test_order();
+    test_producers();
+    test_task_scheduler();
+}
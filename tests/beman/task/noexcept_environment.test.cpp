@@ -0,0 +1,72 @@
+// tests/beman/task/noexcept_environment.test.cpp                     -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/noexcept_environment.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <concepts>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+int caught{};
+
+struct hook_environment {
+    using error_types = ex::completion_signatures<>;
+    static auto unhandled_exception() noexcept -> void {
+        try {
+            throw;
+        } catch (const std::runtime_error&) {
+            ++caught;
+        }
+    }
+};
+
+static_assert(std::same_as<bt::error_types_of_t<ex::noexcept_environment>, ex::completion_signatures<>>);
+static_assert(not bt::unhandled_exception_hook<ex::noexcept_environment>);
+static_assert(not bt::unhandled_exception_hook<bt::default_environment>);
+static_assert(bt::unhandled_exception_hook<hook_environment>);
+
+using noexcept_signatures = ex::task<int, ex::noexcept_environment>::completion_signatures;
+static_assert(bt::meta::list_contains_v<noexcept_signatures, ex::set_value_t(int)>);
+static_assert(not bt::meta::list_contains_v<noexcept_signatures, ex::set_error_t(std::exception_ptr)>);
+using hook_signatures = ex::task<void, hook_environment>::completion_signatures;
+static_assert(bt::meta::list_contains_v<hook_signatures, ex::set_stopped_t()>);
+static_assert(not bt::meta::list_contains_v<hook_signatures, ex::set_error_t(std::exception_ptr)>);
+
+auto test_value() -> void {
+    auto rc{ex::sync_wait([]() -> ex::task<int, ex::noexcept_environment> {
+        co_return co_await []() -> ex::task<int, ex::noexcept_environment> { co_return 17; }();
+    }())};
+    assert(rc);
+    assert(std::get<0>(*rc) == 17);
+}
+
+auto test_hook() -> void {
+    // std::terminate() is called once the hook returned: report success from the handler.
+    std::set_terminate([] { std::_Exit(caught == 1 ? EXIT_SUCCESS : EXIT_FAILURE); });
+    ex::sync_wait([]() -> ex::task<void, hook_environment> {
+        co_await []() -> ex::task<void, hook_environment> {
+            throw std::runtime_error("failed");
+            co_return;
+        }();
+        assert(nullptr == "a task failing with the hook doesn't resume its parent");
+    }());
+    assert(nullptr == "a task failing with the hook doesn't complete");
+}
+} // namespace
+
+int main() {
+    test_value();
+    test_hook();
+}
@@ -0,0 +1,135 @@
+// tests/beman/task/numa_context.test.cpp                             -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/numa_context.hpp>
+#include <beman/task/detail/allocator_support.hpp>
+#include <beman/task/detail/can_run_inline.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <cstddef>
+#include <optional>
+#include <tuple>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4291)
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+struct numa_frame : bt::allocator_support<bt::numa_frame_allocator<>> {
+    char data[100]{};
+};
+
+struct numa_env {
+    using allocator_type = bt::numa_frame_allocator<>;
+};
+
+// Two nodes sharing CPU 0 to get multiple nodes independent of the machine.
+auto two_nodes() -> bt::numa_context::options {
+    return bt::numa_context::options{.nodes = {{0u}, {0u}}, .threads_per_node = 1u, .pin = false};
+}
+
+void test_discover() {
+    const std::vector<std::size_t> cpus{0u, 1u, 2u, 3u, 8u, 10u, 11u};
+    assert(bt::numa_context::parse_cpulist("0-3,8,10-11\n") == cpus);
+    assert(bt::numa_context::parse_cpulist("").empty());
+
+    const auto nodes{bt::numa_context::discover()};
+    assert(not nodes.empty());
+    assert(not nodes.front().empty());
+
+    bt::numa_context context;
+    assert(context.size() == nodes.size());
+    assert(not bt::numa_context::current_node());
+}
+
+void test_allocator() {
+    static_assert(bt::allocator_support<bt::numa_frame_allocator<>>::stateless);
+    bt::numa_context context(two_nodes());
+
+    // not on a node's thread: the frame comes from the heap
+    delete new numa_frame{};
+    assert(context.get_stats(0u).allocations == 0u);
+
+    auto [released]{ex::sync_wait(ex::schedule(context.get_scheduler(0u)) | ex::then([&context] {
+                                      assert(bt::numa_context::current_node() == std::optional<std::size_t>(0u));
+                                      assert(bt::can_run_inline(context.get_scheduler(0u)));
+                                      assert(not bt::can_run_inline(context.get_scheduler(1u)));
+                                      delete new numa_frame{};
+                                      return new numa_frame{};
+                                  }))
+                        .value_or(std::tuple<numa_frame*>(nullptr))};
+    assert(released != nullptr);
+    delete released;
+
+    const auto stats{context.get_stats(0u)};
+    assert(stats.allocations == 2u);
+    assert(stats.reused == 1u);
+    assert(stats.remote_releases == 1u);
+    assert(context.get_stats(1u).allocations == 0u);
+
+    [[maybe_unused]] bt::numa_frame_allocator<> alloc{ex::get_allocator(context.get_scheduler(1u))};
+}
+
+void test_cache() {
+    bt::numa_context context(two_nodes());
+    ex::sync_wait(ex::schedule(context.get_scheduler(0u)) | ex::then([] {
+                      // More frames than the thread caches: some go through the node's arena.
+                      std::vector<numa_frame*> frames;
+                      for (int round{}; round != 2; ++round) {
+                          for (std::size_t i{}; i != 3u * bt::numa_context::batch; ++i)
+                              frames.push_back(new numa_frame{});
+                          for (numa_frame* frame : frames)
+                              delete frame;
+                          frames.clear();
+                      }
+                  }));
+
+    const auto stats{context.get_stats(0u)};
+    assert(stats.allocations == 6u * bt::numa_context::batch);
+    assert(stats.reused == 3u * bt::numa_context::batch);
+    assert(stats.remote_releases == 0u);
+}
+
+auto child() -> ex::task<std::size_t, numa_env> { co_return bt::numa_context::current_node().value_or(99u); }
+
+auto hop(bt::numa_context& context) -> ex::task<std::size_t, numa_env> {
+    assert(co_await child() == 0u);
+    co_await ex::change_coroutine_scheduler(ex::task_scheduler(context.get_scheduler(1u)));
+    // The child is created on node 0 but its parent resumes on node 1.
+    co_await child();
+    co_return co_await child();
+}
+
+void test_task() {
+    bt::numa_context context(two_nodes());
+    auto [node]{ex::sync_wait(ex::starts_on(context.get_scheduler(0u), hop(context))).value_or(std::tuple(99u))};
+    assert(node == 1u);
+
+    const auto stats0{context.get_stats(0u)};
+    const auto stats1{context.get_stats(1u)};
+    assert(2u <= stats0.allocations);
+    assert(1u <= stats1.allocations);
+    assert(1u <= stats0.migrations_out);
+    assert(1u <= stats1.migrations_in);
+}
+} // namespace
+
+int main() {
+    test_discover();
+    test_allocator();
+    test_cache();
+    test_task();
+}
@@ -6,6 +6,9 @@
 #include <beman/task/detail/poly.hpp>
 #include <array>
 #include <concepts>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include <utility>
 #ifdef NDEBUG
 #undef NDEBUG
@@ -51,6 +54,10 @@ struct immovable_concrete : immovable_base {
 struct immovable_big : immovable_base {
     std::array<void*, 8> member{};
 };
+struct immovable_large : immovable_concrete {
+    std::array<void*, 8> member{};
+    using immovable_concrete::immovable_concrete;
+};
 // ----------------------------------------------------------------------------
 struct copyable_base {
     copyable_base()                                = default;
@@ -159,6 +166,43 @@ struct equals_concrete : equals_base {
     bool operator==(const equals_concrete&) const noexcept = default;
 };
 // ----------------------------------------------------------------------------
+struct test_resource : std::pmr::memory_resource {
+    std::size_t outstanding{};
+
+    void* do_allocate(std::size_t size, std::size_t) override {
+        this->outstanding += size;
+        return ::operator new(size);
+    }
+    void do_deallocate(void* ptr, std::size_t size, std::size_t) override {
+        ::operator delete(ptr);
+        this->outstanding -= size;
+    }
+    bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+};
+
+struct spill_base {
+    spill_base()                                = default;
+    spill_base(const spill_base&)               = default;
+    spill_base(spill_base&&)                    = default;
+    virtual ~spill_base()                       = default;
+    spill_base&  operator=(const spill_base&)   = delete;
+    spill_base&  operator=(spill_base&&)        = delete;
+    virtual void move(void*)                    = 0;
+    virtual void clone(void*) const             = 0;
+    virtual int  ivalue() const                 = 0;
+};
+
+template <std::size_t N>
+struct spill_concrete : spill_base {
+    std::array<int, N> data{};
+    explicit spill_concrete(int v) { this->data.front() = v; }
+    void move(void* d) override { new (d) spill_concrete(std::move(*this)); }
+    void clone(void* d) const override { new (d) spill_concrete(*this); }
+    int  ivalue() const override { return this->data.front(); }
+};
+using small_concrete = spill_concrete<2u>;
+using large_concrete = spill_concrete<32u>;
+// ----------------------------------------------------------------------------
 template <bool Expect, typename Base, typename Concrete>
 void test_poly_exists() {
     static_assert(Expect == requires { ex::detail::poly<Base>(static_cast<Concrete*>(nullptr)); });
@@ -246,6 +290,70 @@ void test_poly_equals_exists() {
     static_assert(Expect == requires(const ex::detail::poly<Base> p) { p != p; });
 }
 // ----------------------------------------------------------------------------
+void test_poly_spill() {
+    using alloc_t = std::pmr::polymorphic_allocator<std::byte>;
+    using poly_t  = ex::detail::poly<spill_base, 4u * sizeof(void*), alloc_t>;
+    static_assert(poly_t::fits<small_concrete>);
+    static_assert(not poly_t::fits<large_concrete>);
+
+    ex::detail::poly<immovable_base, 4u * sizeof(void*), std::allocator<std::byte>> large(
+        static_cast<immovable_large*>(nullptr), 17, true);
+    assert(large.allocated());
+    assert(large->ivalue() == 17);
+    assert(large->bvalue() == true);
+
+    test_resource r1{};
+    test_resource r2{};
+    {
+        poly_t small(std::allocator_arg, alloc_t(&r1), static_cast<small_concrete*>(nullptr), 17);
+        assert(not small.allocated());
+        assert(small->ivalue() == 17);
+        assert(r1.outstanding == 0u);
+
+        poly_t large(std::allocator_arg, alloc_t(&r1), static_cast<large_concrete*>(nullptr), 18);
+        assert(large.allocated());
+        assert(large->ivalue() == 18);
+        assert(r1.outstanding == sizeof(large_concrete));
+
+        // the moved-from poly keeps a valid object
+        poly_t moved(std::move(large));
+        assert(moved.allocated());
+        assert(moved->ivalue() == 18);
+        assert(large.allocated());
+        assert(large->ivalue() == 18); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+        assert(r1.outstanding == 2u * sizeof(large_concrete));
+
+        poly_t copy(std::allocator_arg, alloc_t(&r1), static_cast<small_concrete*>(nullptr), 0);
+        copy = moved;
+        assert(copy.allocated());
+        assert(copy->ivalue() == 18);
+        assert(r1.outstanding == 3u * sizeof(large_concrete));
+
+        {
+            poly_t extended(std::allocator_arg, alloc_t(&r2), moved);
+            assert(extended.get_allocator() == alloc_t(&r2));
+            assert(extended->ivalue() == 18);
+            assert(r2.outstanding == sizeof(large_concrete));
+        }
+        assert(r2.outstanding == 0u);
+
+        poly_t other(std::allocator_arg, alloc_t(&r2), static_cast<small_concrete*>(nullptr), 19);
+        other = std::move(copy);
+        assert(other.allocated());
+        assert(other->ivalue() == 18);
+        assert(copy->ivalue() == 18); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+        assert(r1.outstanding == 3u * sizeof(large_concrete));
+        assert(r2.outstanding == sizeof(large_concrete));
+
+        other = small;
+        assert(not other.allocated());
+        assert(other->ivalue() == 17);
+        assert(r2.outstanding == 0u);
+    }
+    assert(r1.outstanding == 0u);
+    assert(r2.outstanding == 0u);
+}
+// ----------------------------------------------------------------------------
 } // namespace
 
 int main() {
@@ -296,4 +404,6 @@ int main() {
         { b.equals(&b) } -> std::same_as<bool>;
     });
     test_poly_equals_exists<true, equals_base>();
+
+    test_poly_spill();
 }
@@ -55,27 +55,21 @@ struct state : bt::state_base<T, env<E...>> {
 
     stop_source_type source;
     Environment      ev;
+    scheduler_type   scheduler{ex::inline_scheduler()};
     bool             completed{};
     bool             token{};
-    bool             got_environment{};
 
-    ::std::coroutine_handle<> do_complete() override {
+    state() : bt::state_base<T, env<E...>>(this) { this->bind(this->scheduler, this->ev); }
+
+    ::std::coroutine_handle<> do_complete() {
         this->completed = true;
         return std::noop_coroutine();
     }
-    allocator_type  do_get_allocator() override { return allocator_type{}; }
-    stop_token_type do_get_stop_token() override {
+    allocator_type  do_get_allocator() { return allocator_type{}; }
+    stop_token_type do_get_stop_token() {
         this->token = true;
         return this->source.get_token();
     }
-    Environment& do_get_environment() override {
-        this->got_environment = true;
-        return this->ev;
-    }
-    auto do_get_start_scheduler() -> scheduler_type override { return scheduler_type(ex::inline_scheduler()); }
-    auto do_set_start_scheduler(scheduler_type) -> scheduler_type override {
-        return scheduler_type(ex::inline_scheduler());
-    }
 };
 
 template <typename T>
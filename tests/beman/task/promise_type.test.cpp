@@ -132,7 +132,10 @@ struct test_task : beman::task::detail::state_base<int, environment> {
     using allocator_type = ::beman::task::detail::allocator_of_t<environment>;
 
     beman::task::detail::handle<promise_type> handle;
-    explicit test_task(beman::task::detail::handle<promise_type> h) : handle(std::move(h)) {}
+    explicit test_task(beman::task::detail::handle<promise_type> h)
+        : beman::task::detail::state_base<int, environment>(this), handle(std::move(h)) {
+        this->bind(this->start_scheduler, this->env);
+    }
 
     void run() {
         this->handle.start(this).resume();
@@ -149,18 +152,14 @@ struct test_task : beman::task::detail::state_base<int, environment> {
     std::latch       latch{1u};
     environment      env;
     stop_source_type source;
+    scheduler_type   start_scheduler{ex::inline_scheduler()};
 
-    std::coroutine_handle<> do_complete() override {
+    std::coroutine_handle<> do_complete() {
         this->latch.count_down();
         return std::noop_coroutine();
     }
-    allocator_type  do_get_allocator() override { return allocator_type{}; }
-    stop_token_type do_get_stop_token() override { return this->source.get_token(); }
-    environment&    do_get_environment() override { return this->env; }
-    auto do_get_start_scheduler() -> scheduler_type override { return scheduler_type(ex::inline_scheduler()); }
-    auto do_set_start_scheduler(scheduler_type) -> scheduler_type override {
-        return scheduler_type(ex::inline_scheduler());
-    }
+    allocator_type  do_get_allocator() { return allocator_type{}; }
+    stop_token_type do_get_stop_token() { return this->source.get_token(); }
 
     beman::task::detail::task_scheduler scheduler{beman::execution::inline_scheduler{}};
     beman::task::detail::task_scheduler query(beman::execution::get_start_scheduler_t) const noexcept {
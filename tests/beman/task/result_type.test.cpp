@@ -3,6 +3,10 @@
 
 #include <beman/task/detail/result_type.hpp>
 #include <beman/execution/execution.hpp>
+#include <exception>
+#include <expected>
+#include <string>
+#include <variant>
 #ifdef NDEBUG
 #undef NDEBUG
 #endif
@@ -55,6 +59,15 @@ struct error_receiver {
 };
 static_assert(::beman::execution::receiver<error_receiver>);
 
+struct exception_receiver {
+    using receiver_concept = ::beman::execution::receiver_tag;
+    std::exception_ptr& error;
+    void set_value(auto&&...) && noexcept { unexpected_call_assert("unexpected set_value called"); }
+    void set_error(std::exception_ptr e) && noexcept { error = std::move(e); }
+    void set_stopped() && noexcept { unexpected_call_assert("set_stopped unexpectedly called"); }
+};
+static_assert(::beman::execution::receiver<exception_receiver>);
+
 void test_stopped() {
     beman::task::detail::
         result_type<beman::task::detail::stoppable::yes, void, ex::completion_signatures<ex::set_error_t(int)>>
@@ -100,10 +113,115 @@ void test_error() {
     assert(error == 17);
 }
 
+using exception_errors = ex::completion_signatures<ex::set_error_t(std::exception_ptr)>;
+template <typename Value>
+using exception_result =
+    beman::task::detail::result_type<beman::task::detail::stoppable::yes, Value, exception_errors>;
+template <typename Value>
+using no_error_result =
+    beman::task::detail::result_type<beman::task::detail::stoppable::yes, Value, ex::completion_signatures<>>;
+
+static_assert(std::derived_from<exception_result<int>, beman::task::detail::compact_result<
+                                                           beman::task::detail::stoppable::yes,
+                                                           int,
+                                                           true>>);
+static_assert(std::derived_from<no_error_result<void>, beman::task::detail::compact_result<
+                                                           beman::task::detail::stoppable::yes,
+                                                           void,
+                                                           false>>);
+static_assert(not std::derived_from<exception_result<std::string>, beman::task::detail::compact_result<
+                                                                       beman::task::detail::stoppable::yes,
+                                                                       std::string,
+                                                                       true>>);
+static_assert(sizeof(exception_result<int>) <= sizeof(std::variant<std::monostate, int, std::exception_ptr>));
+static_assert(sizeof(no_error_result<int>) <= sizeof(std::variant<std::monostate, int>));
+
+void test_compact() {
+    {
+        exception_result<int> result{};
+        assert(result.no_completion_set());
+        bool flag{false};
+        result.result_complete(stopped_receiver{flag});
+        assert(flag == true);
+    }
+    {
+        exception_result<int> result{};
+        result.set_value(17);
+        assert(not result.no_completion_set());
+        assert(result.result_resume() == 17);
+        int value{};
+        result.result_complete(value_receiver{value});
+        assert(value == 17);
+    }
+    {
+        exception_result<void> result{};
+        result.set_value(::beman::task::detail::void_type());
+        result.result_resume();
+        bool flag{false};
+        result.result_complete(void_receiver{flag});
+        assert(flag == true);
+    }
+    {
+        exception_result<int> result{};
+        result.set_error(std::make_exception_ptr(17));
+        assert(not result.no_completion_set());
+        std::exception_ptr error{};
+        result.result_complete(exception_receiver{error});
+        assert(error);
+    }
+    {
+        exception_result<int> result{};
+        result.set_error(std::make_exception_ptr(17));
+        try {
+            result.result_resume();
+            assert(nullptr == "result_resume() didn't throw");
+        } catch (int e) {
+            assert(e == 17);
+        }
+    }
+    {
+        no_error_result<int> result{};
+        result.set_value(17);
+        int value{};
+        result.result_complete(value_receiver{value});
+        assert(value == 17);
+    }
+}
+void test_expected() {
+    {
+        exception_result<int> result{};
+        result.set_value(17);
+        assert((result.result_expected<std::expected<int, std::exception_ptr>>() == 17));
+    }
+    {
+        exception_result<int> result{};
+        result.set_error(std::make_exception_ptr(17));
+        auto e{result.result_expected<std::expected<int, std::exception_ptr>>()};
+        assert(not e.has_value() && e.error());
+    }
+    {
+        beman::task::detail::result_type<beman::task::detail::stoppable::yes,
+                                         std::string,
+                                         ex::completion_signatures<ex::set_error_t(int), ex::set_error_t(bool)>>
+            result{};
+        result.set_error(17);
+        auto e{result.result_expected<std::expected<std::string, std::variant<int, bool>>>()};
+        assert(not e.has_value() && std::get<int>(e.error()) == 17);
+        result.set_value(std::string("value"));
+        assert((result.result_expected<std::expected<std::string, std::variant<int, bool>>>() == "value"));
+    }
+    {
+        no_error_result<void> result{};
+        result.set_value(::beman::task::detail::void_type());
+        assert((result.result_expected<std::expected<void, int>>().has_value()));
+    }
+}
 } // namespace
 
 int main() {
     test_stopped();
     test_value();
     test_error();
+    test_compact();
+    test_expected();
 }
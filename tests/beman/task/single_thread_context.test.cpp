@@ -13,8 +13,10 @@ namespace ex = beman::execution;
 
 // ----------------------------------------------------------------------------
 
-int main() {
-    ::beman::task::detail::single_thread_context context;
+namespace {
+template <typename Context>
+void test_thread() {
+    Context context;
 
     auto main_id = std::this_thread::get_id();
     auto [thread_id] =
@@ -23,3 +25,9 @@ int main() {
 
     assert(main_id != thread_id);
 }
+} // namespace
+
+int main() {
+    test_thread<::beman::task::detail::single_thread_context>();
+    test_thread<::beman::task::detail::mpsc_single_thread_context>();
+}
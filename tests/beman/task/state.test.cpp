@@ -0,0 +1,79 @@
+// tests/beman/task/state.test.cpp                                    -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <exception>
+#include <utility>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+template <typename Token>
+struct env {
+    Token token;
+    auto  query(const ex::get_stop_token_t&) const noexcept -> Token { return this->token; }
+    auto  query(const ex::get_scheduler_t&) const noexcept -> ex::inline_scheduler { return {}; }
+};
+
+template <typename Token>
+struct receiver {
+    using receiver_concept = ex::receiver_tag;
+    Token token;
+    bool* done;
+
+    auto get_env() const noexcept -> env<Token> { return {this->token}; }
+    auto set_value() && noexcept -> void { *this->done = true; }
+    auto set_error(std::exception_ptr) && noexcept -> void {}
+    auto set_stopped() && noexcept -> void {}
+};
+
+template <typename Source>
+auto test_forwarding(Source& source) -> void {
+    using token_type = decltype(source.get_token());
+    bool done{};
+    auto state{ex::connect(
+        [](Source& src) -> ex::task<> {
+            auto token{co_await ex::read_env(ex::get_stop_token)};
+            assert(token.stop_possible());
+            assert(not token.stop_requested());
+            src.request_stop();
+            assert(token.stop_requested());
+        }(source),
+        receiver<token_type>{source.get_token(), &done})};
+    ex::start(state);
+    assert(done);
+}
+
+auto test_never_stop() -> void {
+    bool done{};
+    auto state{ex::connect(
+        []() -> ex::task<> {
+            auto token{co_await ex::read_env(ex::get_stop_token)};
+            assert(not token.stop_possible());
+        }(),
+        receiver<ex::never_stop_token>{{}, &done})};
+    ex::start(state);
+    assert(done);
+}
+} // namespace
+
+int main() {
+    ex::inplace_stop_source inplace;
+    test_forwarding(inplace);
+    ex::stop_source source;
+    test_forwarding(source);
+    test_never_stop();
+
+    // A compatible upstream stop token doesn't require a stop source in the state.
+    using inplace_state =
+        decltype(ex::connect(std::declval<ex::task<>>(), std::declval<receiver<ex::inplace_stop_token>>()));
+    using other_state = decltype(ex::connect(std::declval<ex::task<>>(), std::declval<receiver<ex::stop_token>>()));
+    static_assert(sizeof(inplace_state) + sizeof(ex::inplace_stop_source) <= sizeof(other_state));
+}
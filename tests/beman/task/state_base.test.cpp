@@ -21,27 +21,39 @@ struct state : beman::task::detail::state_base<int, environment> {
     using allocator_type = ::beman::task::detail::allocator_of_t<environment>;
     stop_source_type source;
     environment      env;
+    scheduler_type   scheduler{ex::inline_scheduler()};
     bool             completed{};
     bool             token{};
-    bool             got_environment{};
 
-    ::std::coroutine_handle<> do_complete() override {
+    state() : beman::task::detail::state_base<int, environment>(this) { this->bind(this->scheduler, this->env); }
+
+    ::std::coroutine_handle<> do_complete() {
         this->completed = true;
         return std::noop_coroutine();
     }
-    allocator_type  do_get_allocator() override { return allocator_type{}; }
-    stop_token_type do_get_stop_token() override {
+    allocator_type  do_get_allocator() { return allocator_type{}; }
+    stop_token_type do_get_stop_token() {
         this->token = true;
         return this->source.get_token();
     }
-    environment& do_get_environment() override {
-        this->got_environment = true;
-        return this->env;
-    }
-    auto do_get_start_scheduler() -> scheduler_type override { return scheduler_type(ex::inline_scheduler()); }
-    auto do_set_start_scheduler(scheduler_type) -> scheduler_type override {
-        return scheduler_type(ex::inline_scheduler());
+};
+
+struct bound_state : beman::task::detail::state_base<int, environment> {
+    using allocator_type = ::beman::task::detail::allocator_of_t<environment>;
+    stop_source_type source;
+    stop_token_type  token{source.get_token()};
+    environment      env;
+    scheduler_type   scheduler{ex::inline_scheduler()};
+    allocator_type   allocator{};
+
+    bound_state() : beman::task::detail::state_base<int, environment>(this) {
+        this->bind(this->scheduler, this->env);
+        this->bind_stop_token(this->token);
     }
+
+    ::std::coroutine_handle<> do_complete() { return std::noop_coroutine(); }
+    allocator_type            do_get_allocator() { return allocator_type{}; }
+    const allocator_type*     do_get_allocator_ptr() const noexcept { return &this->allocator; }
 };
 } // namespace
 
@@ -55,7 +67,20 @@ int main() {
     s.get_stop_token();
     assert(s.token == true);
 
-    assert(s.got_environment == false);
-    s.get_environment();
-    assert(s.got_environment == true);
+    assert(&s.get_environment() == &s.env);
+    assert(s.get_allocator_ptr() == nullptr);
+
+    assert(s.get_start_scheduler() == s.scheduler);
+    assert(not s.start_scheduler_changed());
+    s.set_start_scheduler(s.scheduler);
+    assert(s.get_start_scheduler() == s.scheduler);
+    assert(s.start_scheduler_changed());
+
+    bound_state b;
+    assert(b.get_allocator_ptr() == &b.allocator);
+    assert(b.get_stop_token() == b.source.get_token());
+    assert(not b.get_stop_token().stop_requested());
+    b.source.request_stop();
+    assert(b.get_stop_token().stop_requested());
+    assert(&b.get_environment() == &b.env);
 }
@@ -0,0 +1,41 @@
+// tests/beman/task/stop_forward.test.cpp                             -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/stop_forward.hpp>
+#include <beman/execution/stop_token.hpp>
+#include <type_traits>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+int main() {
+    {
+        // Matching token types: the upstream token is used directly.
+        static_assert(std::is_empty_v<bt::stop_forward<ex::inplace_stop_token, ex::inplace_stop_source>>);
+        ex::inplace_stop_source                                           upstream;
+        bt::stop_forward<ex::inplace_stop_token, ex::inplace_stop_source> forward;
+        assert(forward.get_token(upstream.get_token()) == upstream.get_token());
+    }
+    {
+        // Different token types: stop requests are forwarded.
+        ex::stop_source                                           upstream;
+        bt::stop_forward<ex::stop_token, ex::inplace_stop_source> forward;
+        auto                                                      token{forward.get_token(upstream.get_token())};
+        assert(token.stop_possible());
+        assert(not token.stop_requested());
+        assert(token == forward.get_token(upstream.get_token()));
+        upstream.request_stop();
+        assert(token.stop_requested());
+    }
+    {
+        // An upstream token which can't be stopped doesn't need a stop source.
+        bt::stop_forward<ex::never_stop_token, ex::inplace_stop_source> forward;
+        assert(not forward.get_token(ex::never_stop_token{}).stop_possible());
+    }
+}
@@ -3,7 +3,13 @@
 
 #include <beman/task.hpp>
 #include <beman/execution.hpp>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <latch>
+#include <thread>
 
 namespace ex = beman::execution;
 
@@ -36,6 +42,64 @@ auto test_indirect_cancel() {
     }());
 }
 
+struct stop_source_env {
+    using stop_source_type = ex::stop_source;
+};
+
+struct stop_env {
+    ex::inplace_stop_token token;
+    auto query(const ex::get_stop_token_t&) const noexcept { return this->token; }
+    auto query(const ex::get_scheduler_t&) const noexcept { return ex::inline_scheduler{}; }
+};
+
+struct stop_receiver {
+    using receiver_concept = ex::receiver_tag;
+    ex::inplace_stop_token token;
+    std::latch*            done;
+    auto                   get_env() const noexcept { return stop_env{this->token}; }
+    auto                   set_value() && noexcept { std::terminate(); }
+    auto                   set_error(std::exception_ptr) && noexcept { std::terminate(); }
+    auto                   set_stopped() && noexcept { this->done->count_down(); }
+};
+
+// The innermost task uses a different stop token type to also cover forwarding via a stop source.
+auto wait_until_stopped(std::atomic<bool>& running) -> ex::task<void, stop_source_env> {
+    auto       token{co_await ex::read_env(ex::get_stop_token)};
+    std::latch stopped{1};
+    {
+        auto count_down{[&stopped] { stopped.count_down(); }};
+
+        ex::stop_callback_for_t<decltype(token), decltype(count_down)> callback(token, count_down);
+        running = true;
+        stopped.wait();
+    }
+    co_await ex::just_stopped();
+}
+
+auto chain(std::size_t depth, std::atomic<bool>& running) -> ex::task<> {
+    auto token{co_await ex::read_env(ex::get_stop_token)};
+    assert(token.stop_possible());
+    if (depth == 0u)
+        co_await wait_until_stopped(running);
+    else
+        co_await chain(depth - 1u, running);
+}
+
+auto test_nested_stop() {
+    ex::inplace_stop_source source;
+    std::atomic<bool>       running{};
+    std::latch              done{1};
+    auto                    state{ex::connect(chain(64u, running), stop_receiver{source.get_token(), &done})};
+    std::thread             thread([&state] { ex::start(state); });
+    while (not running)
+        std::this_thread::yield();
+
+    // The innermost task only completes once the stop request reached it.
+    source.request_stop();
+    done.wait();
+    thread.join();
+}
+
 auto test_affinity() {
     std::cout << "test_affinity\n";
     ex::sync_wait([]() -> ex::task<> {
@@ -50,11 +114,55 @@ auto test_affinity() {
         }();
     }());
 }
+
+struct eager_env {
+    static constexpr bool eager_start{true};
+};
+
+auto test_eager() {
+    // Completes synchronously: the parent doesn't suspend.
+    auto [value]{ex::sync_wait([]() -> ex::task<int> {
+                     co_return 1 + co_await []() -> ex::task<int, eager_env> { co_return 16; }();
+                 }())
+                     .value_or(std::tuple(0))};
+    assert(value == 17);
+
+    // Suspends: the task completes after the parent suspended.
+    auto [scheduled]{ex::sync_wait([]() -> ex::task<int> {
+                         co_return co_await []() -> ex::task<int, eager_env> {
+                             co_await ex::schedule(co_await ex::read_env(ex::get_scheduler));
+                             co_return 17;
+                         }();
+                     }())
+                         .value_or(std::tuple(0))};
+    assert(scheduled == 17);
+
+    // Stops synchronously: the parent still needs to suspend to become stopped.
+    assert(not ex::sync_wait([]() -> ex::task<> {
+                   co_await []() -> ex::task<void, eager_env> { co_await ex::just_stopped(); }();
+               }()));
+
+    // Errors are delivered as for lazy tasks.
+    bool caught{};
+    ex::sync_wait([](bool& c) -> ex::task<> {
+        try {
+            co_await []() -> ex::task<void, eager_env> {
+                throw 17;
+                co_return;
+            }();
+        } catch (int) {
+            c = true;
+        }
+    }(caught));
+    assert(caught);
+}
 } // namespace
 
 auto main() -> int {
     test_co_return();
     test_cancel();
     test_indirect_cancel();
+    test_nested_stop();
     test_affinity();
+    test_eager();
 }
@@ -2,11 +2,16 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <beman/task/detail/task_scheduler.hpp>
+#include <beman/task/detail/frame_pool.hpp>
 #include <beman/execution/execution.hpp>
 #include <beman/execution/stop_token.hpp>
+#include <array>
 #include <atomic>
+#include <cstddef>
 #include <latch>
 #include <exception>
+#include <memory_resource>
+#include <vector>
 #include <system_error>
 #include <thread>
 #include <condition_variable>
@@ -191,6 +196,197 @@ template <typename Token>
 stop_receiver(Token&&, stop_result&, std::latch* = nullptr) -> stop_receiver<std::remove_cvref_t<Token>>;
 static_assert(ex::receiver<stop_receiver<ex::inplace_stop_token>>);
 
+struct counting_resource : std::pmr::memory_resource {
+    std::size_t allocations{};
+    std::size_t outstanding{};
+
+    void* do_allocate(std::size_t size, std::size_t) override {
+        ++this->allocations;
+        this->outstanding += size;
+        return ::operator new(size);
+    }
+    void do_deallocate(void* ptr, std::size_t size, std::size_t) override {
+        ::operator delete(ptr);
+        this->outstanding -= size;
+    }
+    bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// A scheduler whose scheduler, sender, and operation state don't fit into task_scheduler's buffers.
+struct big_scheduler {
+    using scheduler_concept = ex::scheduler_tag;
+
+    template <ex::receiver Receiver>
+    struct state {
+        using operation_state_concept = ex::operation_state_tag;
+        std::remove_cvref_t<Receiver> receiver;
+        std::array<void*, 32>         padding{};
+        void                          start() & noexcept { ex::set_value(std::move(this->receiver)); }
+    };
+    struct env {
+        big_scheduler query(const ex::get_completion_scheduler_t<ex::set_value_t>&) const noexcept { return {}; }
+    };
+    struct sender {
+        using sender_concept        = ex::sender_tag;
+        using completion_signatures = ex::completion_signatures<ex::set_value_t()>;
+        template <typename Env>
+        static consteval auto get_completion_signatures() -> completion_signatures {
+            return {};
+        }
+
+        std::array<void*, 8> padding{};
+
+        template <ex::receiver Receiver>
+        auto connect(Receiver&& receiver) {
+            return state<Receiver>{std::forward<Receiver>(receiver)};
+        }
+        env get_env() const noexcept { return {}; }
+    };
+    static_assert(ex::sender<sender>);
+
+    std::array<void*, 8> padding{};
+
+    sender schedule() noexcept { return {}; }
+    bool   operator==(const big_scheduler&) const = default;
+};
+static_assert(ex::scheduler<big_scheduler>);
+
+struct allocator_env {
+    std::pmr::polymorphic_allocator<std::byte> alloc;
+    auto query(const ex::get_allocator_t&) const noexcept { return this->alloc; }
+};
+struct allocator_receiver {
+    using receiver_concept = ex::receiver_tag;
+    allocator_env env;
+    bool&         done;
+    auto          get_env() const noexcept { return this->env; }
+    void          set_value() && noexcept { this->done = true; }
+};
+static_assert(ex::receiver<allocator_receiver>);
+
+// A scheduler customizing bulk to count how often the customization is used.
+std::size_t bulk_customizations{};
+std::size_t bulk_shape{};
+struct counting_domain {
+    template <ex::sender Sndr, typename Env>
+        requires std::same_as<ex::tag_of_t<std::remove_cvref_t<Sndr>>, ex::bulk_t>
+    auto transform_sender(Sndr&& sndr, const Env&) const {
+        auto [tag, data, child] = std::forward<Sndr>(sndr);
+        auto [shape, fun]       = std::move(data);
+        ++bulk_customizations;
+        bulk_shape = std::size_t(shape);
+        return ex::then(std::move(child), [shape, fun]() mutable {
+            for (decltype(shape) i{}; i != shape; ++i)
+                fun(i);
+        });
+    }
+};
+struct bulk_scheduler {
+    using scheduler_concept = ex::scheduler_tag;
+    struct env {
+        bulk_scheduler query(const ex::get_completion_scheduler_t<ex::set_value_t>&) const noexcept { return {}; }
+    };
+    struct sender {
+        using sender_concept        = ex::sender_tag;
+        using completion_signatures = ex::completion_signatures<ex::set_value_t()>;
+        template <typename...>
+        static consteval auto get_completion_signatures() -> completion_signatures {
+            return {};
+        }
+        template <ex::receiver Receiver>
+        auto connect(Receiver&& receiver) const {
+            return ex::connect(ex::just(), std::forward<Receiver>(receiver));
+        }
+        env get_env() const noexcept { return {}; }
+    };
+    std::size_t threads{};
+
+    sender          schedule() const noexcept { return {}; }
+    counting_domain query(const ex::get_domain_t&) const noexcept { return {}; }
+    std::size_t     query(const ly::detail::parallelism_t&) const noexcept { return this->threads; }
+    bool            operator==(const bulk_scheduler&) const = default;
+};
+static_assert(ex::scheduler<bulk_scheduler>);
+
+void test_bulk() {
+    ly::detail::task_scheduler sched(bulk_scheduler{});
+    std::vector<int>           hits(100u);
+    bulk_customizations = 0u;
+    auto result{ex::sync_wait(ex::bulk(ex::schedule(sched) | ex::then([] { return 17; }),
+                                       hits.size(),
+                                       [&hits](std::size_t i, int value) {
+                                           assert(value == 17);
+                                           ++hits[i];
+                                       }))};
+    assert(result);
+    assert(std::get<0>(*result) == 17);
+    assert(bulk_customizations == 1u);
+    // bulk_scheduler{} isn't parallel: all indices are processed as one chunk.
+    assert(bulk_shape == 1u);
+    for (int h : hits)
+        assert(h == 1);
+
+    ly::detail::task_scheduler parallel(bulk_scheduler{3u});
+    assert(ly::detail::parallelism(parallel) == 3u);
+    ex::sync_wait(ex::bulk(ex::schedule(parallel), hits.size(), [&hits](std::size_t i) { ++hits[i]; }));
+    assert(bulk_shape == ly::detail::chunk_count(hits.size(), 3u));
+    for (int h : hits)
+        assert(h == 2);
+
+    bool caught{false};
+    try {
+        ex::sync_wait(ex::bulk(ex::schedule(sched), 10u, [](std::size_t i) {
+            if (i == 3u)
+                throw 17;
+        }));
+    } catch (int e) {
+        caught = e == 17;
+    }
+    assert(caught);
+}
+
+void test_allocator() {
+    using allocator_type = ly::detail::task_scheduler::allocator_type;
+    counting_resource sched_resource;
+    counting_resource op_resource;
+    {
+        ly::detail::task_scheduler sched(big_scheduler{}, allocator_type(&sched_resource));
+        assert(sched.get_allocator() == allocator_type(&sched_resource));
+        assert(0u < sched_resource.outstanding);
+        const std::size_t size{sched_resource.outstanding};
+
+        ly::detail::task_scheduler copy(sched);
+        assert(copy == sched);
+        assert(copy.get_allocator() == allocator_type(&sched_resource));
+        assert(sched_resource.outstanding == 2u * size);
+
+        // a moved-from scheduler can still be compared and used
+        ly::detail::task_scheduler moved(std::move(copy));
+        assert(moved == sched);
+        assert(copy == sched); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+        assert(sched_resource.outstanding == 3u * size);
+
+        bool done{false};
+        auto sndr{copy.schedule()};
+        assert(3u * size < sched_resource.outstanding);
+        auto state{ex::connect(std::move(sndr), allocator_receiver{{allocator_type(&op_resource)}, done})};
+        assert(0u < op_resource.outstanding);
+        ex::start(state);
+        assert(done);
+    }
+    assert(sched_resource.outstanding == 0u);
+    assert(op_resource.outstanding == 0u);
+    assert(0u < op_resource.allocations);
+
+    ly::detail::task_scheduler plain(ex::inline_scheduler{}, std::allocator<int>{});
+    assert(plain.get_allocator() == allocator_type());
+
+    // Other stateless allocators are adapted; stateful ones are rejected at compile time.
+    ly::detail::task_scheduler pooled(ex::inline_scheduler{}, ly::detail::frame_pool_allocator<>{});
+    assert(pooled.get_allocator() != allocator_type());
+    assert(pooled.get_allocator() == ly::detail::task_scheduler(pooled).get_allocator());
+}
+
 } // namespace
 
 // ----------------------------------------------------------------------------
@@ -227,6 +423,16 @@ int main() {
         assert(move == sched2);
         assert(move != sched1);
 
+        ly::detail::task_scheduler inl(ex::inline_scheduler{});
+        assert(inl == inl);
+        assert(inl != sched1);
+        assert(sched1 != inl);
+        assert(inl == ex::inline_scheduler{});
+        assert(sched1 == ctxt1.get_scheduler());
+        assert(sched1 != ctxt2.get_scheduler());
+        assert(sched1 != ex::inline_scheduler{});
+        assert(inl != ctxt1.get_scheduler());
+
         std::atomic<std::thread::id> id1{};
         std::atomic<std::thread::id> id2{};
         ex::sync_wait(ex::schedule(sched1) | ex::then([&id1]() { id1 = std::this_thread::get_id(); }));
@@ -259,6 +465,9 @@ int main() {
             completed.wait();
             assert(result == stop_result::success);
         }
+
+        test_allocator();
+        test_bulk();
     } catch (...) {
         unexpected_call_assert("no exception should escape to main");
     }
@@ -0,0 +1,165 @@
+// tests/beman/task/thread_pool_context.test.cpp                      -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/thread_pool_context.hpp>
+#include <beman/task/detail/can_run_inline.hpp>
+#include <beman/task/detail/task_scheduler.hpp>
+#include <beman/execution/execution.hpp>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <latch>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+static_assert(ex::scheduler<bt::thread_pool_context::scheduler>);
+
+struct counting_receiver {
+    using receiver_concept = ex::receiver_tag;
+    std::atomic<std::size_t>* executed;
+    std::latch*               gate{};
+
+    auto set_value() && noexcept -> void {
+        if (this->gate)
+            this->gate->wait();
+        ++*this->executed;
+    }
+};
+
+// Operation states aren't movable: they are created in place from the result of make().
+template <typename Operation>
+struct operation {
+    Operation op;
+    template <typename Make>
+    explicit operation(Make make) : op(make()) {}
+};
+
+auto test_threads() -> void {
+    bt::thread_pool_context context(4u);
+    assert(context.size() == 4u);
+    assert(bt::thread_pool_context(0u).size() == 1u);
+
+    auto main_id = std::this_thread::get_id();
+    auto [result] =
+        ex::sync_wait(ex::schedule(context.get_scheduler()) | ex::then([&context] {
+                          return std::tuple(std::this_thread::get_id(), bt::can_run_inline(context.get_scheduler()));
+                      }))
+            .value_or(std::tuple(std::tuple(main_id, false)));
+    auto [thread_id, inline_ok] = result;
+    assert(main_id != thread_id);
+    assert(inline_ok);
+    assert(not bt::can_run_inline(context.get_scheduler()));
+}
+
+auto test_many_producers() -> void {
+    constexpr std::size_t     producers{4u};
+    constexpr std::size_t     count{1000u};
+    std::atomic<std::size_t>  executed{};
+    std::mutex                mutex;
+    std::set<std::thread::id> ids;
+    {
+        bt::thread_pool_context  context(4u);
+        std::vector<std::thread> threads;
+        for (std::size_t p{}; p != producers; ++p)
+            threads.emplace_back([&] {
+                for (std::size_t i{}; i != count; ++i)
+                    ex::sync_wait(ex::schedule(context.get_scheduler()) | ex::then([&] {
+                                      ++executed;
+                                      std::lock_guard cerberus(mutex);
+                                      ids.insert(std::this_thread::get_id());
+                                  }));
+            });
+        for (auto& t : threads)
+            t.join();
+    }
+    assert(executed == producers * count);
+    assert(not ids.empty() && ids.size() <= 4u);
+}
+
+auto test_finish() -> void {
+    constexpr std::size_t    count{10u};
+    std::atomic<std::size_t> executed{};
+    std::latch               gate(1);
+    using operation_t =
+        operation<decltype(ex::connect(std::declval<bt::thread_pool_context::sender>(), counting_receiver{}))>;
+    // The operation states need to outlive the workers.
+    std::deque<operation_t> ops;
+    {
+        bt::thread_pool_context context(1u);
+        auto                    sched{context.get_scheduler()};
+
+        // The only worker blocks on the first item while the others are queued behind it.
+        ops.emplace_back([&] { return ex::connect(ex::schedule(sched), counting_receiver{&executed, &gate}); });
+        ex::start(ops.back().op);
+        for (std::size_t i{}; i != count; ++i) {
+            ops.emplace_back([&] { return ex::connect(ex::schedule(sched), counting_receiver{&executed}); });
+            ex::start(ops.back().op);
+        }
+        // Work which is already scheduled is still completed after finish().
+        context.finish();
+        gate.count_down();
+    }
+    assert(executed == count + 1u);
+}
+
+auto test_task_scheduler() -> void {
+    bt::thread_pool_context context(2u);
+    bt::task_scheduler      sched(context.get_scheduler());
+    auto                    main_id = std::this_thread::get_id();
+    auto [thread_id] = ex::sync_wait(ex::schedule(sched) | ex::then([] { return std::this_thread::get_id(); }))
+                           .value_or(std::tuple(main_id));
+    assert(main_id != thread_id);
+}
+
+auto test_pinning() -> void {
+#if defined(__linux__)
+    // Pin to the last CPU the process may use to avoid depending on the machine.
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    assert(::sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+    int target{-1};
+    for (int cpu{}; cpu != CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &allowed))
+            target = cpu;
+    assert(0 <= target);
+
+    bt::thread_pool_context context(bt::thread_pool_context::options{
+        .threads = 2u, .pin = true, .cpus = {static_cast<std::size_t>(target)}});
+    assert(context.pinned() == 2u);
+    auto [cpu] = ex::sync_wait(ex::schedule(context.get_scheduler()) | ex::then([] { return ::sched_getcpu(); }))
+                     .value_or(std::tuple(-1));
+    assert(cpu == target);
+
+    // A CPU which can't be used leaves the workers unpinned.
+    bt::thread_pool_context unpinned(
+        bt::thread_pool_context::options{.threads = 1u, .pin = true, .cpus = {std::size_t(CPU_SETSIZE)}});
+    assert(unpinned.pinned() == 0u);
+#endif
+    assert(bt::thread_pool_context(2u).pinned() == 0u);
+}
+} // namespace
+
+int main() {
+    test_threads();
+    test_many_producers();
+    test_finish();
+    test_task_scheduler();
+    test_pinning();
+}
@@ -0,0 +1,107 @@
+// tests/beman/task/trace.test.cpp                                    -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#define BEMAN_TASK_TRACE
+#include <beman/task/detail/trace.hpp>
+#include <beman/task.hpp>
+#include <beman/execution.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+std::atomic<std::size_t> hook_calls{};
+
+auto count(const std::vector<bt::trace::thread_records>& threads, bt::trace_event event) -> std::size_t {
+    std::size_t rc{};
+    for (const auto& t : threads)
+        rc += std::size_t(std::ranges::count(t.records, event, &bt::trace::record::event));
+    return rc;
+}
+
+auto test_ring_buffer() -> void {
+    bt::trace::clear();
+    int object{};
+    std::thread([&object] {
+        for (std::size_t i{}; i != bt::trace::capacity + 10u; ++i)
+            bt::trace::emit(bt::trace_event::resume, &object);
+    }).join();
+    auto threads{bt::trace::collect()};
+    assert(count(threads, bt::trace_event::resume) <= bt::trace::capacity);
+    std::size_t dropped{};
+    for (const auto& t : threads)
+        dropped += t.dropped;
+    assert(count(threads, bt::trace_event::resume) + dropped == bt::trace::capacity + 10u);
+    assert(count(bt::trace::collect(), bt::trace_event::resume) == 0u);
+}
+
+auto test_exited_threads() -> void {
+    bt::trace::clear();
+    int object{};
+    for (std::size_t i{}; i != 2u * bt::trace::max_exited; ++i)
+        std::thread([&object] { bt::trace::emit(bt::trace_event::resume, &object); }).join();
+    // only the buffers of the most recently exited threads are kept
+    auto threads{bt::trace::collect()};
+    assert(bt::trace::max_exited <= count(threads, bt::trace_event::resume));
+    assert(count(threads, bt::trace_event::resume) <= bt::trace::max_exited + 1u);
+    // collected buffers of exited threads are released
+    assert(bt::trace::collect().size() <= 1u);
+}
+
+auto test_task_events() -> void {
+    bt::trace::clear();
+    bt::trace::hook_type previous{bt::trace::set_hook([](bt::trace_event, const void*) noexcept { ++hook_calls; })};
+    assert(previous == nullptr);
+
+    ex::sync_wait([]() -> ex::task<> {
+        co_await []() -> ex::task<> { co_return; }();
+        co_await ex::just();
+    }());
+
+    auto threads{bt::trace::collect()};
+    assert(count(threads, bt::trace_event::create) == 2u);
+    assert(count(threads, bt::trace_event::start) == 2u);
+    assert(count(threads, bt::trace_event::complete) == 2u);
+    assert(count(threads, bt::trace_event::destroy) == 2u);
+    assert(count(threads, bt::trace_event::suspend) == count(threads, bt::trace_event::resume));
+    assert(1u <= count(threads, bt::trace_event::suspend));
+    std::size_t total{};
+    for (const auto& t : threads)
+        total += t.records.size();
+    assert(hook_calls == total);
+    bt::trace::set_hook(nullptr);
+}
+
+auto test_export() -> void {
+    bt::trace::clear();
+    ex::sync_wait([]() -> ex::task<> { co_return; }());
+    std::ostringstream out;
+    bt::trace::export_chrome(out);
+    const std::string json{out.str()};
+    assert(json.starts_with("{\"traceEvents\":["));
+    assert(json.find("\"ph\":\"b\"") != std::string::npos);
+    assert(json.find("\"ph\":\"e\"") != std::string::npos);
+    assert(json.find("\"name\":\"create\"") != std::string::npos);
+}
+} // namespace
+
+int main() {
+    static_assert(bt::trace::enabled);
+    test_ring_buffer();
+    test_exited_threads();
+    test_task_events();
+    test_export();
+}
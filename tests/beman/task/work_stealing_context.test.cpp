@@ -0,0 +1,156 @@
+// tests/beman/task/work_stealing_context.test.cpp                    -*-C++-*-
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <beman/task/detail/work_stealing_context.hpp>
+#include <beman/task/detail/infallible_scheduler.hpp>
+#include <beman/task/detail/task_scheduler.hpp>
+#include <beman/execution/execution.hpp>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <latch>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+namespace ex = beman::execution;
+namespace bt = beman::task::detail;
+
+// ----------------------------------------------------------------------------
+
+namespace {
+using scheduler = bt::work_stealing_context::scheduler;
+
+struct counting_receiver {
+    using receiver_concept = ex::receiver_tag;
+    std::atomic<std::size_t>* count;
+    std::latch*               done;
+    void                      set_value() && noexcept {
+        this->count->fetch_add(1u);
+        this->done->count_down();
+    }
+};
+static_assert(ex::receiver<counting_receiver>);
+
+struct item {
+    decltype(ex::connect(ex::schedule(std::declval<scheduler&>()), std::declval<counting_receiver>())) state;
+    item(scheduler sched, counting_receiver r) : state(ex::connect(ex::schedule(sched), std::move(r))) {}
+};
+
+// Each node schedules two more nodes until depth reaches zero.
+struct node;
+struct node_receiver {
+    using receiver_concept = ex::receiver_tag;
+    node* self;
+    void  set_value() && noexcept;
+};
+struct node {
+    scheduler                 sched;
+    std::size_t               depth;
+    std::atomic<std::size_t>* count;
+    std::latch*               done;
+    decltype(ex::connect(ex::schedule(std::declval<scheduler&>()), std::declval<node_receiver>())) state;
+
+    node(scheduler s, std::size_t d, std::atomic<std::size_t>* c, std::latch* l)
+        : sched(s), depth(d), count(c), done(l), state(ex::connect(ex::schedule(this->sched), node_receiver{this})) {
+        ex::start(this->state);
+    }
+};
+void node_receiver::set_value() && noexcept {
+    node* n{this->self};
+    if (0u < n->depth) {
+        new node(n->sched, n->depth - 1u, n->count, n->done);
+        new node(n->sched, n->depth - 1u, n->count, n->done);
+    }
+    n->count->fetch_add(1u);
+    std::latch* done{n->done};
+    delete n;
+    done->count_down();
+}
+
+void test_fan_out(bt::work_stealing_context& context) {
+    constexpr std::size_t    size{4096u};
+    std::atomic<std::size_t> count{};
+    std::latch               done{size};
+    std::deque<item>         items;
+    for (std::size_t i{}; i != size; ++i)
+        items.emplace_back(context.get_scheduler(), counting_receiver{&count, &done});
+    for (auto& i : items)
+        ex::start(i.state);
+    done.wait();
+    assert(count == size);
+}
+
+void test_nested(bt::work_stealing_context& context) {
+    constexpr std::size_t    depth{10u};
+    constexpr std::size_t    size{(std::size_t(1u) << (depth + 1u)) - 1u};
+    std::atomic<std::size_t> count{};
+    std::latch               done{size};
+    new node(context.get_scheduler(), depth, &count, &done);
+    done.wait();
+    assert(count == size);
+}
+void test_bulk(bt::work_stealing_context& context) {
+    std::vector<std::atomic<int>> hits(1000u);
+    ex::sync_wait(ex::bulk(ex::schedule(context.get_scheduler()), hits.size(), [&hits](std::size_t i) {
+        hits[i].fetch_add(1);
+    }));
+    for (auto& h : hits)
+        assert(h == 1);
+
+    bt::task_scheduler erased(context.get_scheduler());
+    auto               result{ex::sync_wait(
+        ex::bulk(ex::schedule(erased) | ex::then([] { return 17; }), hits.size(), [&hits](std::size_t i, int v) {
+            assert(v == 17);
+            hits[i].fetch_add(1);
+        }))};
+    assert(result && std::get<0>(*result) == 17);
+    for (auto& h : hits)
+        assert(h == 2);
+}
+} // namespace
+
+int main() {
+    static_assert(ex::scheduler<scheduler>);
+    static_assert(bt::infallible_scheduler<scheduler, ex::env<>>);
+
+    {
+        bt::work_stealing_context context(4u);
+        assert(context.size() == 4u);
+        assert(context.get_scheduler() == context.get_scheduler());
+        bt::work_stealing_context other(1u);
+        assert(context.get_scheduler() != other.get_scheduler());
+
+        auto sched{context.get_scheduler()};
+        assert(ex::get_completion_scheduler<ex::set_value_t>(ex::get_env(ex::schedule(sched))) == sched);
+
+        auto main_id = std::this_thread::get_id();
+        auto [thread_id] =
+            ex::sync_wait(ex::schedule(sched) | ex::then([] { return std::this_thread::get_id(); }))
+                .value_or(std::tuple(std::thread::id{}));
+        assert(main_id != thread_id);
+
+        bt::task_scheduler erased(sched);
+        assert(erased == sched);
+        auto [erased_id] =
+            ex::sync_wait(ex::schedule(erased) | ex::then([] { return std::this_thread::get_id(); }))
+                .value_or(std::tuple(std::thread::id{}));
+        assert(main_id != erased_id);
+
+        test_fan_out(context);
+        test_nested(context);
+        test_fan_out(other);
+        test_nested(other);
+        test_bulk(context);
+        test_bulk(other);
+    }
+    {
+        bt::work_stealing_context context;
+        assert(0u < context.size());
+        test_nested(context);
+    }
+}